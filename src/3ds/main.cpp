@@ -25,6 +25,7 @@
 #include "../apu.h"
 #include "../config.h"
 #include "../mutex.h"
+#include "../pacer.h"
 
 bool running = true;
 bool requestSave, requestLoad;
@@ -52,9 +53,17 @@ const vector<config::Setting> platformSettings =
 
 void runCore(void *args)
 {
+    pacer::reset();
+
     while (running)
     {
-        core::runCycle();
+        core::runFrame();
+
+        // Pace emulation by the audio clock or the frame deadline, depending on settings
+        if (config::audioSync)
+            pacer::syncAudio();
+        else if (config::frameLimiter)
+            pacer::limitFrame();
 
         if (requestSave)
         {
@@ -102,6 +111,7 @@ int main(int argc, char **argv)
     ndspChnSetFormat(0, NDSP_FORMAT_STEREO_PCM16);
     ndspChnSetInterp(0, NDSP_INTERP_LINEAR);
     ndspChnSetRate(0, 48000);
+    pacer::setSampleRate(48000);
     float mix[] = { 1.0f, 1.0f };
     ndspChnSetMix(0, mix);
 
@@ -159,6 +169,7 @@ int main(int argc, char **argv)
                 waveBuffers[currentBuf].data_pcm16[i * 2 + 1] = sample;
             }
             ndspChnWaveBufAdd(0, &waveBuffers[currentBuf]);
+            pacer::consumeSamples(waveBuffers[currentBuf].nsamples);
             currentBuf = !currentBuf;
         }
 
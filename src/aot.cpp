@@ -0,0 +1,110 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "aot.h"
+#include "mapper.h"
+
+namespace aot
+{
+
+typedef struct
+{
+    uint32_t checksum;
+    const Routine *routines;
+    uint32_t count;
+} Rom;
+
+// Routines for the current ROM sorted by address, and where each address starts in them
+vector<const Routine*> routines;
+uint32_t starts[0x8001];
+
+// The cycle count a routine can reach before the PPU or APU could raise an interrupt, past which it has to return
+uint32_t limit;
+
+vector<Rom> &roms()
+{
+    // Keep the list in a function so that it exists before other files register with it
+    static vector<Rom> list;
+    return list;
+}
+
+Registration::Registration(uint32_t checksum, const Routine *routines, uint32_t count)
+{
+    // Add the recompiled routines of a ROM
+    Rom rom = { checksum, routines, count };
+    roms().push_back(rom);
+}
+
+bool compareRoutines(const Routine *a, const Routine *b)
+{
+    return a->address < b->address;
+}
+
+void load(const uint8_t *prg, uint32_t size)
+{
+    // Find the recompiled routines for a ROM, if any were built in
+    routines.clear();
+    uint32_t hash = checksum(prg, size);
+    for (unsigned int i = 0; i < roms().size(); i++)
+    {
+        if (roms()[i].checksum == hash)
+        {
+            for (uint32_t j = 0; j < roms()[i].count; j++)
+                routines.push_back(&roms()[i].routines[j]);
+        }
+    }
+
+    // Index the routines by address
+    stable_sort(routines.begin(), routines.end(), compareRoutines);
+    uint32_t j = 0;
+    for (uint32_t i = 0; i <= 0x8000; i++)
+    {
+        while (j < routines.size() && routines[j]->address < 0x8000 + i)
+            j++;
+        starts[i] = j;
+    }
+
+    if (!routines.empty())
+        printf("Using %u recompiled routines\n", (unsigned int)routines.size());
+}
+
+bool execute()
+{
+    // Run a recompiled routine if there is one for the program counter and the PRG bank mapped there
+    uint16_t address = cpu::programCounter;
+    if (address < 0x8000)
+        return false;
+
+    for (uint32_t i = starts[address - 0x8000]; i < starts[address - 0x8000 + 1]; i++)
+    {
+        if (routines[i]->offset == mapper::prgOffset(address))
+        {
+            limit = cpu::targetCycles + cpu::eventCycles();
+            return routines[i]->function() > 0;
+        }
+    }
+
+    return false;
+}
+
+}
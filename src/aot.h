@@ -0,0 +1,119 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef AOT_H
+#define AOT_H
+
+#include <cstdint>
+
+#include "core.h"
+#include "cpu.h"
+
+namespace aot
+{
+
+typedef struct
+{
+    uint16_t address;
+    uint32_t offset; // Location of the first instruction in PRG ROM
+    int (*function)(); // Returns the number of instructions run
+} Routine;
+
+class Registration
+{
+    public:
+        Registration(uint32_t checksum, const Routine *routines, uint32_t count);
+};
+
+extern uint32_t limit;
+
+void load(const uint8_t *prg, uint32_t size);
+bool execute();
+
+inline uint32_t checksum(const uint8_t *data, uint32_t size)
+{
+    // Identify a PRG ROM with a 32-bit FNV-1a hash
+    uint32_t hash = 2166136261U;
+    for (uint32_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 16777619U;
+    return hash;
+}
+
+// Helpers for recompiled code, matching the interpreter's behavior; arithmetic and compares use the CPU's own
+
+inline void setNZ(uint8_t value)
+{
+    cpu::nzResult = value;
+}
+
+inline void bit(uint8_t value)
+{
+    cpu::flags = (cpu::flags & 0xBF) | (value & 0x40);
+    cpu::nzResult = ((value & 0x80) << 8) | (cpu::accumulator & value);
+}
+
+inline uint8_t asl(uint8_t value)
+{
+    cpu::flags = (cpu::flags & 0xFE) | (value >> 7);
+    setNZ(value << 1);
+    return value << 1;
+}
+
+inline uint8_t lsr(uint8_t value)
+{
+    cpu::flags = (cpu::flags & 0xFE) | (value & 0x01);
+    setNZ(value >> 1);
+    return value >> 1;
+}
+
+inline uint8_t rol(uint8_t value)
+{
+    uint8_t result = (value << 1) | (cpu::flags & 0x01);
+    cpu::flags = (cpu::flags & 0xFE) | (value >> 7);
+    setNZ(result);
+    return result;
+}
+
+inline uint8_t ror(uint8_t value)
+{
+    uint8_t result = (value >> 1) | ((cpu::flags & 0x01) << 7);
+    cpu::flags = (cpu::flags & 0xFE) | (value & 0x01);
+    setNZ(result);
+    return result;
+}
+
+inline uint16_t indirectX(uint8_t pointer)
+{
+    return cpu::memory[(uint8_t)(pointer + cpu::registerX)] | (cpu::memory[(uint8_t)(pointer + cpu::registerX + 1)] << 8);
+}
+
+inline uint16_t indirectY(uint8_t pointer)
+{
+    return (cpu::memory[pointer] | (cpu::memory[(uint8_t)(pointer + 1)] << 8)) + cpu::registerY;
+}
+
+inline bool direct(uint16_t address, bool write)
+{
+    // Check that an access goes to memory rather than a register handler
+    return write ? cpu::pages[address >> 8].write : cpu::pages[address >> 8].read;
+}
+
+}
+
+#endif // AOT_H
@@ -288,7 +288,7 @@ void runCycle()
         if (frameCounter == 14915 && !(frameCounterFlags & 0x40))
         {
             status |= 0x40;
-            cpu::interrupts[2] = true;
+            cpu::assertIrq(cpu::IRQ_FRAME);
         }
 
         if (frameCounter == 14915 || frameCounter == 18641)
@@ -313,6 +313,16 @@ void runCycle()
         noiseLength = 0;
 }
 
+uint32_t nextEvent()
+{
+    // Count the global cycles until the frame counter can raise its interrupt, where 0 is the current one
+    if (frameCounterFlags & 0xC0)
+        return 0xFFFFFFFF;
+    if (frameCounter >= 14915)
+        return 0;
+    return (6 - core::globalCycles % 6) % 6 + (14915 - frameCounter - 1) * 6;
+}
+
 uint8_t registerRead(uint16_t address)
 {
     uint8_t value = 0;
@@ -326,7 +336,10 @@ uint8_t registerRead(uint16_t address)
                 value |= (pulseLengths[i] > 0) << i;
             value |= (triangleLength > 0) << 2;
             value |= (noiseLength > 0) << 3;
+
+            // Reading the status acknowledges the frame interrupt
             status &= ~0x40;
+            cpu::acknowledgeIrq(cpu::IRQ_FRAME);
             break;
     }
 
@@ -405,7 +418,10 @@ void registerWrite(uint16_t address, uint8_t value)
         case 0x4017: // Frame counter
             frameCounterFlags = value;
             if (frameCounterFlags & 0x40) // Interrupt inhibit
+            {
                 status &= ~0x40; // Frame interrupt
+                cpu::acknowledgeIrq(cpu::IRQ_FRAME);
+            }
             frameCounter = 0;
             break;
     }
@@ -27,6 +27,7 @@ int16_t audioSample(float pitch);
 
 void reset();
 void runCycle();
+uint32_t nextEvent();
 
 uint8_t registerRead(uint16_t address);
 void registerWrite(uint16_t address, uint8_t value);
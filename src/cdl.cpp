@@ -0,0 +1,133 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <vector>
+
+#include "core.h"
+#include "cdl.h"
+#include "config.h"
+#include "cpu.h"
+#include "mapper.h"
+
+namespace cdl
+{
+
+// A byte of flags for every byte of PRG and CHR ROM
+vector<uint8_t> prgLog, chrLog;
+
+uint8_t *chrPages[8];
+uint8_t sink[0x400];
+
+// The bytes of the instruction about to run, whose fetches aren't counted as data reads
+uint16_t fetchAddress;
+uint8_t fetchLength;
+
+void reset(uint32_t prgSize, uint32_t chrSize)
+{
+    // Start empty logs for a ROM, or none if logging is off
+    prgLog.assign(config::codeLog ? prgSize : 0, 0);
+    chrLog.assign(config::codeLog ? chrSize : 0, 0);
+    for (int i = 0; i < 8; i++)
+        chrPages[i] = sink;
+    fetchLength = 0;
+}
+
+void mapChr(uint8_t window, uint32_t offset)
+{
+    // Point the log of a CHR window at the bank mapped to it, or at the sink if there's no CHR ROM to log
+    chrPages[window] = (offset + 0x400 <= chrLog.size()) ? &chrLog[offset] : sink;
+}
+
+void execute()
+{
+    // Mark the opcode and operands of the instruction about to run
+    fetchAddress = cpu::programCounter;
+    fetchLength = cpu::instructionLength(cpu::memoryPeek(fetchAddress));
+    for (int i = 0; i < fetchLength; i++)
+    {
+        uint16_t address = fetchAddress + i;
+        if (address < 0x8000)
+            continue;
+        uint32_t offset = mapper::prgOffset(address);
+        if (offset < prgLog.size())
+            prgLog[offset] |= i ? PRG_OPERAND : PRG_OPCODE;
+    }
+}
+
+uint8_t prgRead(uint16_t address)
+{
+    // Mark a byte of PRG ROM as data, unless the read is a fetch of the current instruction
+    uint32_t offset = mapper::prgOffset(address);
+    if ((uint16_t)(address - fetchAddress) >= fetchLength && offset < prgLog.size())
+        prgLog[offset] |= PRG_DATA;
+    return mapper::prgRead(address);
+}
+
+void load(string romName)
+{
+    // Merge in the log from earlier sessions, if there is one for a ROM of the same size
+    FILE *file = fopen((romName + ".cdl").c_str(), "rb");
+    if (!file)
+        return;
+    fseek(file, 0, SEEK_END);
+    if ((size_t)ftell(file) == prgLog.size() + chrLog.size())
+    {
+        vector<uint8_t> old(prgLog.size() + chrLog.size());
+        fseek(file, 0, SEEK_SET);
+        fread(old.data(), 1, old.size(), file);
+        for (size_t i = 0; i < prgLog.size(); i++)
+            prgLog[i] |= old[i];
+        for (size_t i = 0; i < chrLog.size(); i++)
+            chrLog[i] |= old[prgLog.size() + i];
+    }
+    fclose(file);
+}
+
+void write(string romName)
+{
+    if (prgLog.empty())
+        return;
+
+    // Write the PRG log followed by the CHR log
+    FILE *file = fopen((romName + ".cdl").c_str(), "wb");
+    if (!file)
+        return;
+    fwrite(prgLog.data(), 1, prgLog.size(), file);
+    fwrite(chrLog.data(), 1, chrLog.size(), file);
+    fclose(file);
+
+    // Report how much of each ROM has been seen
+    size_t code = 0, data = 0, chr = 0;
+    for (size_t i = 0; i < prgLog.size(); i++)
+    {
+        code += (prgLog[i] & (PRG_OPCODE | PRG_OPERAND)) != 0;
+        data += (prgLog[i] & PRG_DATA) != 0;
+    }
+    for (size_t i = 0; i < chrLog.size(); i++)
+        chr += chrLog[i] != 0;
+
+    printf("Wrote the code/data log to %s.cdl (PRG %.1f%% code, %.1f%% data", romName.c_str(),
+        code * 100.0 / prgLog.size(), data * 100.0 / prgLog.size());
+    if (!chrLog.empty())
+        printf(", CHR %.1f%% used", chr * 100.0 / chrLog.size());
+    printf(")\n");
+}
+
+}
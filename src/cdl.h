@@ -0,0 +1,63 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CDL_H
+#define CDL_H
+
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+namespace cdl
+{
+
+enum PrgFlag
+{
+    PRG_OPCODE  = 0x01,
+    PRG_OPERAND = 0x02,
+    PRG_DATA    = 0x04
+};
+
+enum ChrFlag
+{
+    CHR_RENDERED = 0x01,
+    CHR_READ     = 0x02
+};
+
+// The log of each 1 KB CHR window, or a sink that nothing reads when logging is off
+extern uint8_t *chrPages[8];
+
+inline void logChr(uint16_t address, uint8_t flag)
+{
+    // Mark a byte of pattern data without checking whether logging is on
+    chrPages[address >> 10][address & 0x3FF] |= flag;
+}
+
+void reset(uint32_t prgSize, uint32_t chrSize);
+void mapChr(uint8_t window, uint32_t offset);
+void execute();
+uint8_t prgRead(uint16_t address);
+
+void load(string romName);
+void write(string romName);
+
+}
+
+#endif // CDL_H
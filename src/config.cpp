@@ -27,12 +27,32 @@ namespace config
 {
 
 uint32_t frameLimiter = 1;
+uint32_t audioSync = 0;
 uint32_t disableSpriteLimit = 0;
+uint32_t decodeCache = 1;
+uint32_t jit = 0;
+uint32_t recompiled = 0;
+uint32_t idleSkip = 1;
+uint32_t trace = 0;
+uint32_t profile = 0;
+uint32_t codeLog = 0;
+uint32_t checkpoints = 0;
+uint32_t busEvents = 0;
 
 vector<Setting> settings =
 {
     { "frameLimiter",       &frameLimiter,       false },
-    { "disableSpriteLimit", &disableSpriteLimit, false }
+    { "audioSync",          &audioSync,          false },
+    { "disableSpriteLimit", &disableSpriteLimit, false },
+    { "decodeCache",        &decodeCache,        false },
+    { "jit",                &jit,                false },
+    { "recompiled",         &recompiled,         false },
+    { "idleSkip",           &idleSkip,           false },
+    { "trace",              &trace,              false },
+    { "profile",            &profile,            false },
+    { "codeLog",            &codeLog,            false },
+    { "checkpoints",        &checkpoints,        false },
+    { "busEvents",          &busEvents,          false }
 };
 
 void load(vector<Setting> platformSettings)
@@ -36,7 +36,17 @@ typedef struct
 } Setting;
 
 extern uint32_t frameLimiter;
+extern uint32_t audioSync;
 extern uint32_t disableSpriteLimit;
+extern uint32_t decodeCache;
+extern uint32_t jit;
+extern uint32_t recompiled;
+extern uint32_t idleSkip;
+extern uint32_t trace;
+extern uint32_t profile;
+extern uint32_t codeLog;
+extern uint32_t checkpoints;
+extern uint32_t busEvents;
 
 void load(vector<Setting> platformSettings);
 void save();
@@ -24,7 +24,15 @@
 #include "cpu.h"
 #include "ppu.h"
 #include "apu.h"
+#include "cdl.h"
+#include "config.h"
+#include "debugger.h"
+#include "events.h"
+#include "perf.h"
 #include "mapper.h"
+#include "profiler.h"
+#include "timing.h"
+#include "trace.h"
 
 namespace core
 {
@@ -34,6 +42,15 @@ uint8_t globalCycles;
 string romName;
 bool hasBattery;
 
+// With checkpoints on, a hash of the state at the end of every frame is written, each one chained to the last
+uint32_t frameCount;
+FILE *checkpoints;
+uint64_t checkpointHash;
+
+// A lag frame is one in which the game never read the joypads
+uint32_t lagFrames;
+bool lagFrame;
+
 int loadRom(string filename)
 {
     // Open the file
@@ -64,7 +81,15 @@ int loadRom(string filename)
     cpu::reset();
     ppu::reset();
     apu::reset();
+    trace::reset();
+    profiler::reset();
+    debugger::reset();
+    events::reset();
+    timing::reset();
     globalCycles = 0;
+    frameCount = 0;
+    lagFrames = 0;
+    lagFrame = false;
 
     // Load the trainer into memory if the ROM has one
     if (header[6] & 0x04)
@@ -72,13 +97,28 @@ int loadRom(string filename)
 
     // Initialize the ROM mapper
     ppu::mirrorMode = (header[6] & 0x08) ? 4 : 3 - (header[6] & 0x01);
-    uint8_t mapperType = header[7] | (header[6] >> 4);
+    uint8_t mapperType = mapper::headerType(header);
     if (!mapper::load(file, header[4], mapperType))
     {
         printf("Unknown mapper type: %d\n", mapperType);
         return mapperType;
     }
 
+    // Continue the code/data log from earlier sessions
+    if (config::codeLog)
+        cdl::load(romName);
+
+    // Start the streams for comparing runs, if enabled
+    if (config::trace == 2)
+        trace::startStream(romName + ".trace");
+    if (config::checkpoints)
+    {
+        if (checkpoints)
+            fclose(checkpoints);
+        checkpoints = fopen((romName + ".checkpoints").c_str(), "w");
+        checkpointHash = 1469598103934665603ULL;
+    }
+
     // Attempt to load a savefile if the ROM has battery-backed SRAM
     if (header[6] & 0x02)
     {
@@ -96,6 +136,26 @@ int loadRom(string filename)
 
 void closeRom()
 {
+    // Write the profile if one was taken
+    if (config::profile)
+        profiler::write(romName);
+
+    // Write the code/data log if one is being kept
+    if (config::codeLog)
+        cdl::write(romName);
+
+    // Write the bus event timeline of the last frame if one is being recorded
+    if (config::busEvents)
+        events::write(romName);
+
+    // Finish the streams for comparing runs
+    trace::stopStream();
+    if (checkpoints)
+    {
+        fclose(checkpoints);
+        checkpoints = nullptr;
+    }
+
     // Write a savefile if the ROM has battery-backed SRAM
     if (hasBattery)
     {
@@ -107,13 +167,143 @@ void closeRom()
 
 void runCycle()
 {
-    // Run a global cycle
+    // Run a global cycle, holding the rest of it while the debugger is stopped so that it resumes where it left off
+    cpu::runCycle();
+    if (debugger::stopped)
+        return;
+    ppu::runCycle();
+    apu::runCycle();
+    ++globalCycles %= 6;
+}
+
+void runCountedCycle()
+{
+    // Run a global cycle, marking the phases that performance counter samples are charged to
+    perf::phase = perf::PHASE_CPU;
     cpu::runCycle();
+    if (debugger::stopped)
+        return;
+    perf::phase = perf::PHASE_PPU;
     ppu::runCycle();
+    perf::phase = perf::PHASE_APU;
     apu::runCycle();
+    perf::phase = perf::PHASE_OTHER;
     ++globalCycles %= 6;
 }
 
+void runTimedCycle()
+{
+    // Run a global cycle, timing each component to estimate where the frame's time goes
+    timing::countdown = timing::sampleInterval;
+    timing::sampledCount++;
+    uint64_t start = timing::ticks();
+    cpu::runCycle();
+    uint64_t cpuEnd = timing::ticks();
+    timing::sampledTicks[timing::STAGE_CPU] += cpuEnd - start;
+    if (debugger::stopped)
+        return;
+    ppu::runCycle();
+    uint64_t ppuEnd = timing::ticks();
+    apu::runCycle();
+    timing::sampledTicks[timing::STAGE_APU] += timing::ticks() - ppuEnd;
+    ++globalCycles %= 6;
+
+    // Leave out the cycle that finishes a frame, since the handoff it does is timed on its own
+    if (!ppu::frameFinished)
+        timing::sampledTicks[timing::STAGE_PPU] += ppuEnd - cpuEnd;
+}
+
+uint32_t runWaitCycles(uint32_t count)
+{
+    // Run the PPU and APU through global cycles in which the CPU only waits, charging the CPU for them at once; a
+    // finished frame stops early, with the CPU charged for the cycles it has started
+    uint32_t run = 0;
+    while (run < count && !ppu::frameFinished)
+    {
+        ppu::runCycle();
+        if (globalCycles == 0)
+            apu::runCycle();
+        ++globalCycles %= 6;
+        run++;
+    }
+    cpu::waitCycles((run + 2) / 3);
+    return run;
+}
+
+void writeState(FILE *state)
+{
+    // Write the state of every component in order
+    cpu::saveState(state);
+    ppu::saveState(state);
+    apu::saveState(state);
+    mapper::saveState(state);
+    fwrite(&globalCycles, 1, sizeof(globalCycles), state);
+}
+
+void checkpoint()
+{
+    // Serialize the state to a scratch file and fold it into the chained hash
+    static FILE *scratch = tmpfile();
+    if (!scratch)
+        return;
+    rewind(scratch);
+    writeState(scratch);
+    long size = ftell(scratch);
+    rewind(scratch);
+
+    uint8_t buffer[0x1000];
+    while (size > 0)
+    {
+        size_t count = fread(buffer, 1, (size < (long)sizeof(buffer)) ? size : sizeof(buffer), scratch);
+        if (count == 0)
+            break;
+        for (size_t i = 0; i < count; i++)
+            checkpointHash = (checkpointHash ^ buffer[i]) * 1099511628211ULL;
+        size -= count;
+    }
+
+    fprintf(checkpoints, "frame %u: %016llx\n", frameCount, (unsigned long long)checkpointHash);
+}
+
+void runFrame()
+{
+    // Run global cycles until the PPU finishes a frame, or until the debugger stops; cycles that the CPU spends waiting
+    // are run without stepping it
+    timing::startFrame();
+    while (!ppu::frameFinished)
+    {
+        if (debugger::stopped)
+            return;
+        if (perf::counting)
+            runCountedCycle();
+        else if (--timing::countdown == 0)
+            runTimedCycle();
+        else if (uint32_t waiting = min<uint32_t>(cpu::waitingCycles() * 3, timing::countdown))
+            timing::countdown -= runWaitCycles(waiting) - 1;
+        else
+            runCycle();
+    }
+    ppu::frameFinished = false;
+
+    // Close the frame's performance counts and timing before anything else is done at its end
+    if (perf::counting)
+        perf::endFrame();
+    timing::endFrame();
+
+    // Count the frame as lag if it never polled input
+    lagFrame = !cpu::inputPolled;
+    lagFrames += lagFrame;
+    cpu::inputPolled = false;
+
+    // Mark the end of the frame in the streams for comparing runs
+    frameCount++;
+    trace::endFrame(frameCount);
+    if (config::busEvents)
+        events::endFrame(frameCount);
+    if (checkpoints)
+        checkpoint();
+}
+
 void pressKey(uint8_t pad, uint8_t key)
 {
     // Set the bit corresponding to the pressed key
@@ -130,11 +320,7 @@ void saveState()
 {
     // Write everything to a state file
     FILE *state = fopen((romName + ".noi").c_str(), "wb");
-    cpu::saveState(state);
-    ppu::saveState(state);
-    apu::saveState(state);
-    mapper::saveState(state);
-    fwrite(&globalCycles, 1, sizeof(globalCycles), state);
+    writeState(state);
     fclose(state);
 }
 
@@ -153,4 +339,41 @@ void loadState()
     }
 }
 
+void dumpTrace()
+{
+    // Bring a streamed trace up to date, since it's already being written
+    if (trace::streaming())
+    {
+        trace::flush();
+        return;
+    }
+
+    // Write the instruction trace to a text file
+    string filename = romName + ".trace";
+    FILE *file = fopen(filename.c_str(), "w");
+    if (!file)
+        return;
+    trace::dump(file);
+    fclose(file);
+    printf("Wrote the instruction trace to %s\n", filename.c_str());
+}
+
+void dumpEvents()
+{
+    // Write the bus event timeline of the last frame
+    events::write(romName);
+}
+
+void dumpTiming()
+{
+    // Write the frame timing statistics to a JSON file
+    string filename = romName + ".timing.json";
+    FILE *file = fopen(filename.c_str(), "w");
+    if (!file)
+        return;
+    timing::write(file);
+    fclose(file);
+    printf("Wrote the frame timing statistics to %s\n", filename.c_str());
+}
+
 }
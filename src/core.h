@@ -36,16 +36,23 @@ typedef struct
 
 extern uint8_t globalCycles;
 
+extern uint32_t lagFrames;
+extern bool lagFrame;
+
 int loadRom(string filename);
 void closeRom();
 
 void runCycle();
+void runFrame();
 
 void pressKey(uint8_t pad, uint8_t key);
 void releaseKey(uint8_t pad, uint8_t key);
 
 void saveState();
 void loadState();
+void dumpTrace();
+void dumpEvents();
+void dumpTiming();
 
 }
 
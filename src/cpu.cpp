@@ -21,9 +21,19 @@
 #include <vector>
 
 #include "core.h"
+#include "aot.h"
+#include "cdl.h"
+#include "config.h"
+#include "cpu.h"
+#include "debugger.h"
+#include "events.h"
+#include "jit.h"
 #include "ppu.h"
 #include "apu.h"
+#include "profiler.h"
+#include "trace.h"
 #include "mapper.h"
+#include "opcodes.h"
 
 namespace cpu
 {
@@ -33,12 +43,18 @@ uint8_t memory[0x10000];
 uint16_t cycles, targetCycles;
 uint16_t programCounter;
 uint8_t accumulator, registerX, registerY;
-uint8_t flags; // NVBBDIZC
+uint8_t flags; // NVBBDIZC, with N and Z only exact after getFlags()
+uint16_t nzResult; // The last result that set N and Z, with bit 15 forcing N
 uint8_t stackPointer;
-bool interrupts[3]; // NMI, RST, IRQ
+uint8_t interrupts; // Bits from the Interrupt enum
 
 uint8_t inputMasks[2];
 uint8_t inputShifts[2];
+bool inputPolled;
+
+// A sprite DMA transfer in progress, which copies its bytes over the stall that ends the current wait
+uint16_t dmaAddress;
+uint16_t dmaCount;
 
 const vector<core::StateItem> stateItems =
 {
@@ -51,41 +67,64 @@ const vector<core::StateItem> stateItems =
     { &registerY,      sizeof(registerY)      },
     { &flags,          sizeof(flags)          },
     { &stackPointer,   sizeof(stackPointer)   },
-    { interrupts,      sizeof(interrupts)     },
-    { inputShifts,     sizeof(inputShifts)    }
+    { &interrupts,     sizeof(interrupts)     },
+    { inputShifts,     sizeof(inputShifts)    },
+    { &dmaAddress,     sizeof(dmaAddress)     },
+    { &dmaCount,       sizeof(dmaCount)       }
 };
 
-void reset()
+// The CPU address space in 256-byte pages, each backed by memory or by a register handler
+Page pages[0x100];
+
+typedef struct
 {
-    // Clear the state items
-    for (unsigned int i = 0; i < stateItems.size(); i++)
-        memset(stateItems[i].pointer, 0, stateItems[i].size);
+    void (*handler)(uint16_t operand);
+    uint16_t operand;
+    uint32_t generation;
+} Decoded;
 
-    // Set default values
-    flags         = 0x24;
-    stackPointer  = 0xFF;
-    interrupts[1] = true;
-    inputMasks[0] = 0;
-    inputMasks[1] = 0;
+// Decoded instructions by address, valid while their generation matches that of their page
+Decoded decoded[0x10000];
+uint32_t generations[0x100];
+
+void markCode(uint8_t page)
+{
+    // Flag a page as holding decoded instructions, including its mirrors if it's RAM
+    for (int i = (page < 0x20) ? page % 8 : page; i <= ((page < 0x20) ? 0x1F : page); i += 8)
+        pages[i].code = true;
 }
 
-uint8_t memoryRead(uint8_t *src)
+void invalidate(uint8_t page)
 {
-    // Just read the value if it's not in memory; it's probably a register
-    if (src < memory || src > memory + sizeof(memory))
-        return *src;
+    // Discard the decoded instructions that start in a page or run into it from the one before, including mirrors
+    for (int i = (page < 0x20) ? page % 8 : page; i <= ((page < 0x20) ? 0x1F : page); i += 8)
+    {
+        generations[i]++;
+        generations[(i - 1) & 0xFF]++;
+        pages[i].code = false;
+    }
+}
 
-    uint16_t address = src - memory;
+uint8_t ppuRead(uint16_t address)
+{
+    // Read from a PPU register, mirrored every 8 bytes
+    return ppu::registerRead(0x2000 + address % 8);
+}
 
-    // Get the real location of a mirrored address in memory
-    if (address >= 0x0800 && address < 0x2000)
-        address %= 0x0800;
-    else if (address >= 0x2008 && address < 0x4000)
-        address = 0x2000 + address % 8;
+void ppuWrite(uint16_t address, uint8_t value)
+{
+    // Write to a PPU register, mirrored every 8 bytes
+    if (config::busEvents)
+        events::record(0x2000 + address % 8, value);
+    ppu::registerWrite(0x2000 + address % 8, value);
+}
 
+uint8_t ioRead(uint16_t address)
+{
     if (address == 0x4016 || address == 0x4017) // JOYPAD1 or JOYPAD2
     {
-        // Read button status 1 bit at a time
+        // Read button status 1 bit at a time, noting that the frame polled input
+        inputPolled = true;
         uint8_t i = address - 0x4016;
         uint8_t value = (inputMasks[i] & (1 << inputShifts[i])) ? 0x41 : 0x40;
         ++inputShifts[i] %= 8;
@@ -93,137 +132,537 @@ uint8_t memoryRead(uint8_t *src)
     }
 
     // Get a value from a memory-mapped register if needed
-    if ((address >= 0x2000 && address < 0x2008) || address == 0x4014)
+    if (address == 0x4014)
         return ppu::registerRead(address);
-    else if (address >= 0x4000 && address < 0x4018)
+    else if (address < 0x4018)
         return apu::registerRead(address);
     else
         return memory[address];
 }
 
-void memoryWrite(uint8_t *dst, uint8_t src)
+void copyDma(int done)
 {
-    // Just write the value if it's not in memory; it's probably a register
-    if (dst < memory || dst > memory + sizeof(memory))
+    // Copy bytes of the DMA transfer until a number of them are done
+    while (dmaCount && 0x100 - dmaCount < done)
     {
-        *dst = src;
-        return;
+        ppu::dmaWrite(dmaAddress, memoryRead(dmaAddress));
+        dmaAddress++;
+        dmaCount--;
     }
+}
+
+void syncDma()
+{
+    // Copy the bytes that the transfer has reached; each one takes 2 of the last 512 cycles of the wait
+    if (dmaCount)
+        copyDma((512 - (targetCycles - cycles)) / 2);
+}
+
+void startDma(uint8_t page)
+{
+    // Finish any earlier transfer that's still in progress
+    copyDma(0x100);
 
-    uint16_t address = dst - memory;
+    // Suspend the CPU for the transfer with an extra cycle on odd CPU cycles, and copy the bytes as the stall runs
+    targetCycles += (core::globalCycles == 3) ? 514 : 513;
+    dmaAddress = page << 8;
+    dmaCount = 0x100;
+}
 
-    // Get the real location of a mirrored address in memory
-    if (address >= 0x0800 && address < 0x2000)
-        address %= 0x0800;
-    else if (address >= 0x2008 && address < 0x4000)
-        address = 0x2000 + address % 8;
+void ioWrite(uint16_t address, uint8_t value)
+{
+    // Note writes to the APU, DMA and joypad registers on the bus event timeline
+    if (config::busEvents && address < 0x4018)
+        events::record(address, value);
 
     if (address == 0x4016) // JOYPAD1
     {
         // Reset the input shifts when the strobe bit is set
-        if (src & 0x01)
+        if (value & 0x01)
             inputShifts[0] = inputShifts[1] = 0;
         return;
     }
 
     // Pass the value to a memory-mapped register if needed
-    if ((address >= 0x2000 && address < 0x2008) || address == 0x4014)
-        ppu::registerWrite(address, src);
-    else if (address >= 0x4000 && address < 0x4018)
-        apu::registerWrite(address, src);
-    else if (address >= 0x8000)
-        mapper::registerWrite(address, src);
+    if (address == 0x4014)
+    {
+        startDma(value);
+    }
+    else if (address < 0x4018)
+    {
+        apu::registerWrite(address, value);
+    }
     else
-        memory[address] = src;
+    {
+        memory[address] = value;
+    }
+}
 
-    // Suspend the CPU on a DMA transfer with an extra cycle on odd CPU cycles
-    if (address == 0x4014)
-        targetCycles += (core::globalCycles == 3) ? 514 : 513;
+enum IdleState
+{
+    IDLE_OFF, IDLE_LEARNING, IDLE_SKIPPING
+};
+
+typedef struct
+{
+    uint16_t address;
+    uint8_t accumulator, registerX, registerY;
+    uint8_t flags;
+    uint8_t stackPointer;
+    uint8_t cycles;
+} IdleStep;
+
+// Loops of up to this many instructions are checked for idling
+const uint8_t maxIdleLength = 16;
+
+// The state of each instruction boundary in one iteration of the loop being learned or skipped
+IdleState idleState;
+IdleStep idleSteps[maxIdleLength];
+uint16_t idleHead, idleEnd, idleRejected;
+uint8_t idleLength, idlePosition, idleMismatches;
+uint16_t idlePeriod;
+bool idleLearned, idleStatus;
+uint8_t idleStatusValue;
+
+bool idleCandidate(uint16_t head, uint16_t end)
+{
+    // Check that a loop's instructions never write and only read RAM, ROM or PPUSTATUS
+    idleStatus = false;
+    int count = 0;
+    for (uint32_t address = head; address <= end; address += length(opcodes[memoryPeek(address)].mode))
+    {
+        if (++count > maxIdleLength)
+            return false;
+
+        const Opcode *opcode = &opcodes[memoryPeek(address)];
+        uint16_t operand = memoryPeek(address + 1) | (memoryPeek(address + 2) << 8);
+
+        switch (opcode->operation)
+        {
+            case LDA: case LDX: case LDY: case AND: case ORA: case EOR: case ADC: case SBC:
+            case CMP: case CPX: case CPY: case BIT: case NOP:
+                break;
+
+            case BCC: case BCS: case BEQ: case BMI: case BNE: case BPL: case BVC: case BVS:
+            case CLC: case SEC: case CLD: case SED: case CLV: case INX: case INY: case DEX:
+            case DEY: case TAX: case TAY: case TXA: case TYA: case TSX: case TXS:
+                continue;
+
+            case ASL: case LSR: case ROL: case ROR:
+                if (opcode->mode == ACC)
+                    continue;
+                return false;
+
+            default:
+                return false;
+        }
+
+        switch (opcode->mode)
+        {
+            case IMP: case IMM: case ZPG: case ZPX: case ZPY:
+                break;
+
+            case ABS:
+                if (operand >= 0x2000 && operand < 0x4000 && (operand & 0x07) == 0x02)
+                    idleStatus = true;
+                else if (operand >= 0x2000 && operand < 0x8000)
+                    return false;
+                break;
+
+            case ABX: case ABY:
+                if (!(operand < 0x2000 - 0xFF) && !(operand >= 0x8000 && operand <= 0xFF00))
+                    return false;
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void idleBranch(uint16_t head, uint16_t end)
+{
+    // Start learning a loop if it looks like it could be idle
+    if (head == idleRejected)
+        return;
+    if (!idleCandidate(head, end))
+    {
+        idleRejected = head;
+        return;
+    }
+
+    idleState = IDLE_LEARNING;
+    idleStatusValue = ppu::status;
+    idleHead = head;
+    idleEnd = end;
+    idlePosition = idleMismatches = 0;
+    idleLearned = false;
+}
+
+void idleMismatch()
+{
+    // Relearn from the current iteration, giving up on loops that keep changing
+    idleLearned = false;
+    if (++idleMismatches > 3)
+    {
+        idleState = IDLE_OFF;
+        idleRejected = idleHead;
+    }
 }
 
-uint8_t *zeroPage()
+void idleSkip()
 {
-    // Use the immediate value as a memory address
-    programCounter++;
-    return &memory[memory[programCounter]];
+    // Charge as many whole iterations as fit; the skip is cut short if an event could change the outcome
+    uint16_t period = 0;
+    for (int i = 0; i < idleLength; i++)
+        period += idleSteps[i].cycles;
+
+    idleState = IDLE_SKIPPING;
+    idlePeriod = period;
+    targetCycles = (0x8000 / period) * period;
 }
 
-uint8_t *zeroPageX()
+void idleStop(uint16_t cycle)
 {
-    // Use the immediate value plus the X register as a memory address in zero page
-    programCounter++;
-    return &memory[(memory[programCounter] + registerX) % 0x100];
+    // Find the first loop boundary at or after a cycle of the skip
+    uint16_t time = cycle - cycle % idlePeriod;
+    int i = 0;
+    while (time < cycle)
+        time += idleSteps[i++].cycles;
+    if (i == idleLength)
+        i = 0;
+
+    // Put the CPU in the state it would have in the instruction that ends there, counting cycles from its start
+    IdleStep *step = &idleSteps[i];
+    uint8_t length = idleSteps[(i + idleLength - 1) % idleLength].cycles;
+    programCounter = step->address;
+    accumulator    = step->accumulator;
+    registerX      = step->registerX;
+    registerY      = step->registerY;
+    setFlags(step->flags);
+    stackPointer   = step->stackPointer;
+    cycles        -= time - length;
+    targetCycles   = length;
+    idleState      = IDLE_OFF;
+
+    // Keep the time that was moved out of the wait in the trace's and the profiler's counts
+    if (config::trace)
+        trace::cycles += time - length;
+    if (config::profile)
+        profiler::charge(time - length);
 }
 
-uint8_t *zeroPageY()
+uint8_t pendingInterrupts()
 {
-    // Use the immediate value plus the Y register as a memory address in zero page
-    programCounter++;
-    return &memory[(memory[programCounter] + registerY) % 0x100];
+    // Get the interrupts that can be taken, leaving out IRQs while the inhibit flag is set
+    return interrupts & ((flags & 0x04) ? ~IRQ_MASK : 0xFF);
 }
 
-uint8_t *absolute()
+bool idleInterrupted()
 {
-    // Use the immediate 2 values as a memory address
-    programCounter += 2;
-    return &memory[memory[programCounter - 1] | (memory[programCounter] << 8)];
+    // Stop skipping when an interrupt can be taken or PPUSTATUS changes
+    if (!pendingInterrupts() && (!idleStatus || ppu::status == idleStatusValue))
+        return false;
+
+    idleStop(cycles);
+    return cycles >= targetCycles;
 }
 
-uint8_t *absoluteX(bool pageCycle)
+bool idleMatches(const IdleStep *step)
 {
-    // Use the absolute value plus the X register as a memory address
-    programCounter += 2;
-    uint16_t address = memory[programCounter - 1] | (memory[programCounter] << 8);
-    if (pageCycle && (address & 0xFF) + registerX > 0xFF) // Page cross
+    // Check if the CPU is in the state recorded for a loop boundary
+    return step->address == programCounter && step->accumulator == accumulator && step->registerX == registerX &&
+        step->registerY == registerY && step->flags == getFlags() && step->stackPointer == stackPointer;
+}
+
+bool idleStep(uint16_t lastCycles)
+{
+    // Keep skipping from the start of the loop, unless PPUSTATUS changed right as the last skip ended
+    if (idleState == IDLE_SKIPPING)
+    {
+        if (idleStatus && ppu::status != idleStatusValue)
+        {
+            idleState = IDLE_OFF;
+            return false;
+        }
+        idleSkip();
+        return true;
+    }
+
+    // Stop learning if the loop was left
+    if (programCounter < idleHead || programCounter > idleEnd)
+    {
+        idleState = IDLE_OFF;
+        return false;
+    }
+
+    // Relearn if PPUSTATUS changes, so that a matching iteration is known to have read the same values throughout
+    if (idleStatus && ppu::status != idleStatusValue)
+    {
+        idleStatusValue = ppu::status;
+        if (idleLearned)
+            idleMismatch();
+    }
+
+    // Record the cycles of the previous instruction, or check them against the last iteration
+    if (idlePosition > 0 && idleSteps[idlePosition - 1].cycles != lastCycles)
+    {
+        idleSteps[idlePosition - 1].cycles = lastCycles;
+        if (idleLearned)
+            idleMismatch();
+    }
+
+    if (programCounter == idleHead && idlePosition > 0)
+    {
+        // Once an iteration reads the same values as the last and ends in the state it started in, every later one
+        // will repeat it until an event changes what the loop reads; a PPUSTATUS read that would clear the V-blank
+        // bit can't be skipped, though
+        if (idleLearned && idlePosition == idleLength && idleMatches(&idleSteps[0]) &&
+            !(idleStatus && (ppu::status & 0x80)))
+        {
+            idleSkip();
+            return true;
+        }
+
+        if (idleLearned && idlePosition != idleLength)
+            idleMismatch();
+        idleLength = idlePosition;
+        idleLearned = true;
+        idlePosition = 0;
+    }
+
+    if (idleState == IDLE_OFF || idlePosition == maxIdleLength)
+    {
+        idleState = IDLE_OFF;
+        return false;
+    }
+
+    // Record the state before the instruction, or check it against the last iteration
+    IdleStep *step = &idleSteps[idlePosition++];
+    if (idleLearned && idlePosition <= idleLength && idleMatches(step))
+        return false;
+
+    if (idleLearned)
+        idleMismatch();
+    step->address      = programCounter;
+    step->accumulator  = accumulator;
+    step->registerX    = registerX;
+    step->registerY    = registerY;
+    step->flags        = getFlags();
+    step->stackPointer = stackPointer;
+    return false;
+}
+
+void assertNmi()
+{
+    // Request an NMI, which is taken once
+    interrupts |= INT_NMI;
+}
+
+void assertIrq(uint8_t source)
+{
+    // Hold the IRQ line for a source
+    interrupts |= source;
+}
+
+void acknowledgeIrq(uint8_t source)
+{
+    // Release the IRQ line for a source
+    interrupts &= ~source;
+}
+
+uint16_t waitingCycles()
+{
+    // Get how many CPU cycles from the current one only wait for the last instruction to finish, which the core can
+    // run without stepping the CPU; an idle loop skip has to be checked on every cycle instead
+    if (core::globalCycles % 3 != 0 || idleState == IDLE_SKIPPING || cycles + 1 >= targetCycles)
+        return 0;
+    return targetCycles - cycles - 1;
+}
+
+void waitCycles(uint16_t count)
+{
+    // Count CPU cycles that the core ran without stepping the CPU
+    cycles += count;
+}
+
+uint16_t eventCycles()
+{
+    // Get how many CPU cycles can pass before the PPU or APU could raise an interrupt or finish the frame, which code
+    // that runs several instructions at once has to stay within to match the interpreter
+    uint32_t distance = min(ppu::nextEvent(), apu::nextEvent()) / 3;
+    return (distance < 0xFFFF) ? distance : 0xFFFF;
+}
+
+void reset()
+{
+    // Clear the state items
+    for (unsigned int i = 0; i < stateItems.size(); i++)
+        memset(stateItems[i].pointer, 0, stateItems[i].size);
+
+    // Set default values
+    idleState     = IDLE_OFF;
+    idleRejected  = 0;
+    stackPointer  = 0xFF;
+    interrupts    = INT_RST;
+    inputMasks[0] = 0;
+    inputMasks[1] = 0;
+    inputPolled   = false;
+    setFlags(0x24);
+
+    // Build the page table
+    for (int i = 0; i < 0x100; i++)
+    {
+        Page *page = &pages[i];
+        memset(page, 0, sizeof(Page));
+
+        if (i < 0x20) // 2 KB of RAM, mirrored
+        {
+            page->read = page->write = &memory[(i % 8) << 8];
+        }
+        else if (i < 0x40) // PPU registers
+        {
+            page->readHandler = ppuRead;
+            page->writeHandler = ppuWrite;
+        }
+        else if (i == 0x40) // APU, DMA and joypad registers
+        {
+            page->readHandler = ioRead;
+            page->writeHandler = ioWrite;
+        }
+        else if (i < 0x80) // Expansion area and SRAM
+        {
+            page->read = page->write = &memory[i << 8];
+        }
+        else // PRG ROM, with writes going to the mapper
+        {
+            page->read = &memory[i << 8];
+            page->writeHandler = mapper::registerWrite;
+        }
+
+        invalidate(i);
+    }
+}
+
+uint8_t memoryRead(uint16_t address)
+{
+    // Read directly from memory if the page is backed by it, or pass the access to the page's handler
+    Page *page = &pages[address >> 8];
+    if (page->watched)
+    {
+        uint8_t value = page->read ? page->read[address & 0xFF] : page->readHandler(address);
+        debugger::watchRead(address, value);
+        return value;
+    }
+    if (page->read)
+        return page->read[address & 0xFF];
+    return page->readHandler(address);
+}
+
+void memoryWrite(uint16_t address, uint8_t value)
+{
+    // Write directly to memory if the page is backed by it, or pass the access to the page's handler
+    Page *page = &pages[address >> 8];
+    if (page->watched)
+        debugger::watchWrite(address, value);
+    if (page->write)
+    {
+        page->write[address & 0xFF] = value;
+        if (page->code)
+            invalidate(address >> 8);
+    }
+    else
+    {
+        page->writeHandler(address, value);
+    }
+}
+
+uint8_t memoryPeek(uint16_t address)
+{
+    // Read memory without triggering the side effects of register handlers
+    Page *page = &pages[address >> 8];
+    if (page->read)
+        return page->read[address & 0xFF];
+    return (address >= 0x8000) ? mapper::prgRead(address) : memory[address];
+}
+
+void mapPrg(uint16_t address, uint8_t *data, uint32_t size)
+{
+    // Point the pages in a PRG window directly at ROM data, making bank switches free of copies
+    // When logging code and data, reads go through the logger instead so that it sees every access
+    for (uint32_t i = 0; i < size; i += 0x100)
+    {
+        Page *page = &pages[(address + i) >> 8];
+        page->read = config::codeLog ? nullptr : &data[i];
+        page->readHandler = cdl::prgRead;
+        invalidate((address + i) >> 8);
+    }
+}
+
+uint16_t zeroPageX(uint8_t operand)
+{
+    // Use the operand plus the X register as a memory address in zero page
+    return (operand + registerX) % 0x100;
+}
+
+uint16_t zeroPageY(uint8_t operand)
+{
+    // Use the operand plus the Y register as a memory address in zero page
+    return (operand + registerY) % 0x100;
+}
+
+uint16_t absoluteX(uint16_t operand, bool pageCycle)
+{
+    // Use the operand plus the X register as a memory address
+    if (pageCycle && (operand & 0xFF) + registerX > 0xFF) // Page cross
         targetCycles++;
-    return &memory[address + registerX];
+    return operand + registerX;
 }
 
-uint8_t *absoluteY(bool pageCycle)
+uint16_t absoluteY(uint16_t operand, bool pageCycle)
 {
-    // Use the absolute value plus the Y register as a memory address
-    programCounter += 2;
-    uint16_t address = memory[programCounter - 1] | (memory[programCounter] << 8);
-    if (pageCycle && (address & 0xFF) + registerY > 0xFF) // Page cross
+    // Use the operand plus the Y register as a memory address
+    if (pageCycle && (operand & 0xFF) + registerY > 0xFF) // Page cross
         targetCycles++;
-    return &memory[address + registerY];
+    return operand + registerY;
 }
 
-uint8_t *indirect()
+uint16_t indirect(uint16_t operand)
 {
-    // Use the value stored at the absolute address as a memory address
-    programCounter += 2;
-    uint16_t addressLower = memory[programCounter - 1] | (memory[programCounter] << 8);
-    uint16_t addressUpper = (addressLower & 0xFF00) | ((addressLower + 1) & 0x00FF);
-    return &memory[(memory[addressUpper] << 8) | memory[addressLower]];
+    // Use the value stored at the operand address as a memory address
+    uint16_t addressUpper = (operand & 0xFF00) | ((operand + 1) & 0x00FF);
+    return (memoryRead(addressUpper) << 8) | memoryRead(operand);
 }
 
-uint8_t *indirectX()
+uint16_t indirectX(uint8_t operand)
 {
-    // Use the value stored at the zero page X address as a memory address
-    programCounter++;
-    uint8_t addressLower = memory[(memory[programCounter] + registerX) % 0x100];
-    uint8_t addressUpper = memory[(memory[programCounter] + registerX + 1) % 0x100];
-    return &memory[(addressUpper << 8) | addressLower];
+    // Use the value stored at the operand plus the X register in zero page as a memory address
+    uint8_t addressLower = memory[(operand + registerX) % 0x100];
+    uint8_t addressUpper = memory[(operand + registerX + 1) % 0x100];
+    if (pages[0x00].watched)
+    {
+        debugger::watchRead((operand + registerX) % 0x100, addressLower);
+        debugger::watchRead((operand + registerX + 1) % 0x100, addressUpper);
+    }
+    return (addressUpper << 8) | addressLower;
 }
 
-uint8_t *indirectY(bool pageCycle)
+uint16_t indirectY(uint8_t operand, bool pageCycle)
 {
-    // Use the value stored at the zero page address plus the Y register as a memory address
-    programCounter++;
-    uint8_t addressLower = memory[memory[programCounter]];
-    uint8_t addressUpper = memory[(memory[programCounter] + 1) % 0x100];
+    // Use the value stored at the operand address in zero page plus the Y register as a memory address
+    uint8_t addressLower = memory[operand];
+    uint8_t addressUpper = memory[(operand + 1) % 0x100];
+    if (pages[0x00].watched)
+    {
+        debugger::watchRead(operand, addressLower);
+        debugger::watchRead((operand + 1) % 0x100, addressUpper);
+    }
     uint16_t address = (addressUpper << 8) | addressLower;
     if (pageCycle && (address & 0xFF) + registerY > 0xFF) // Page cross
         targetCycles++;
-    return &memory[address + registerY];
-}
-
-uint8_t *immediate()
-{
-    // Get the value immediately after the current address
-    programCounter++;
-    return &memory[programCounter];
+    return address + registerY;
 }
 
 void cl_(uint8_t flag)
@@ -238,82 +677,85 @@ void se_(uint8_t flag)
     flags |= flag;
 }
 
+void nz_(uint8_t value)
+{
+    // Keep a result to derive the N and Z flags from when they're observed
+    nzResult = value;
+}
+
 void ph_(uint8_t src)
 {
     // Push a value to the stack
+    if (pages[0x01].watched)
+        debugger::watchWrite(0x100 + stackPointer, src);
     memory[0x100 + stackPointer--] = src;
+    if (pages[0x01].code)
+        invalidate(0x01);
 }
 
-void pl_(uint8_t *dst)
+uint8_t pl_()
 {
     // Pull a value from the stack
-    *dst = memory[0x100 + ++stackPointer];
-
-    if (dst == &flags)
-    {
-        se_(0x20); // B
-        cl_(0x10); // B
-        return;
-    }
+    if (pages[0x01].watched)
+        debugger::watchRead(0x100 + (uint8_t)(stackPointer + 1), memory[0x100 + (uint8_t)(stackPointer + 1)]);
+    return memory[0x100 + ++stackPointer];
+}
 
-    (*dst & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (*dst == 0)   ? se_(0x02) : cl_(0x02); // Z
+void rmw(uint16_t address, uint8_t (*operation)(uint8_t))
+{
+    // Read a value from memory, modify it and write it back
+    memoryWrite(address, operation(memoryRead(address)));
 }
 
-void adc(uint8_t *src)
+void adc(uint16_t src)
 {
     // Add with carry
-    uint8_t before = accumulator;
-    uint8_t value = memoryRead(src);
-    accumulator += value + (flags & 0x01);
-
-    (accumulator & 0x80)                                                    ? se_(0x80) : cl_(0x80); // N
-    (accumulator == 0)                                                      ? se_(0x02) : cl_(0x02); // Z
-    ((value & 0x80) == (before & 0x80) && (flags & 0x80) != (value & 0x80)) ? se_(0x40) : cl_(0x40); // V
-    (before > accumulator || value + (flags & 0x01) == 0x100)               ? se_(0x01) : cl_(0x01); // C
+    addCarry(memoryRead(src));
 }
 
-void _and(uint8_t *src)
+void _and(uint16_t src)
 {
     // Bitwise and
     accumulator &= memoryRead(src);
 
-    (accumulator & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (accumulator == 0)   ? se_(0x02) : cl_(0x02); // Z
+    nz_(accumulator); // N, Z
 }
 
-void asl(uint8_t *dst)
+uint8_t asl(uint8_t before)
 {
     // Arithmetic shift left
-    uint8_t before = memoryRead(dst);
     uint8_t after = before << 1;
-    memoryWrite(dst, after);
 
-    (after & 0x80)  ? se_(0x80) : cl_(0x80); // N
-    (after == 0)    ? se_(0x02) : cl_(0x02); // Z
+    nz_(after); // N, Z
     (before & 0x80) ? se_(0x01) : cl_(0x01); // C
+
+    return after;
 }
 
-void bit(uint8_t *src)
+void bit(uint16_t src)
 {
     // Test bits
     uint8_t value = memoryRead(src);
 
-    (value & 0x80)               ? se_(0x80) : cl_(0x80); // N
-    (value & 0x40)               ? se_(0x40) : cl_(0x40); // V
-    ((accumulator & value) == 0) ? se_(0x02) : cl_(0x02); // Z
+    nzResult = ((value & 0x80) << 8) | (accumulator & value); // N from bit 7 of the value, Z from the and
+    (value & 0x40) ? se_(0x40) : cl_(0x40); // V
 }
 
-void b__(bool condition)
+void b__(bool condition, uint16_t src)
 {
     // Branch on condition
-    int8_t value = *immediate();
+    int8_t value = memoryRead(src);
     if (condition)
     {
         targetCycles++;
         uint16_t dst = programCounter + value + 1;
         if ((dst & 0xFF00) != ((programCounter + 1) & 0xFF00)) // Page cross
             targetCycles++;
+
+        // Watch for an idle loop when branching a short way back, unless every instruction has to be seen by the trace or the debugger
+        if (config::idleSkip && !config::trace && !debugger::active && idleState == IDLE_OFF && dst < programCounter && programCounter - dst <= 0x40)
+            idleBranch(dst, programCounter - 1);
+
         programCounter = dst - 1;
     }
 }
@@ -324,131 +766,126 @@ void brk()
     programCounter += 2;
     ph_(programCounter >> 8);
     ph_(programCounter);
-    se_(0x10); // B
-    ph_(flags);
-    cl_(0x10); // B
+    ph_(getFlags() | 0x10); // B
     se_(0x04); // I
-    programCounter = ((memory[0xFFFF] << 8) | memory[0xFFFE]) - 1;
+    programCounter = ((memoryRead(0xFFFF) << 8) | memoryRead(0xFFFE)) - 1;
+    if (config::profile)
+        profiler::call(programCounter + 1);
 }
 
-void cp_(uint8_t reg, uint8_t *src)
+void cp_(uint8_t reg, uint16_t src)
 {
     // Compare a register to a value
-    uint8_t value = memoryRead(src);
-
-    ((reg - value) & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (reg == value)         ? se_(0x02) : cl_(0x02); // Z
-    (reg >= value)         ? se_(0x01) : cl_(0x01); // C
+    compare(reg, memoryRead(src));
 }
 
-void de_(uint8_t *dst)
+uint8_t de_(uint8_t value)
 {
     // Decrement a value
-    uint8_t value = memoryRead(dst) - 1;
-    memoryWrite(dst, value);
+    value--;
 
-    (value & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (value == 0)   ? se_(0x02) : cl_(0x02); // Z
+    nz_(value); // N, Z
+
+    return value;
 }
 
-void eor(uint8_t *src)
+void eor(uint16_t src)
 {
     // Bitwise exclusive or
     accumulator ^= memoryRead(src);
 
-    (accumulator & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (accumulator == 0)   ? se_(0x02) : cl_(0x02); // Z
+    nz_(accumulator); // N, Z
 }
 
-void in_(uint8_t *dst)
+uint8_t in_(uint8_t value)
 {
     // Increment a value
-    uint8_t value = memoryRead(dst) + 1;
-    memoryWrite(dst, value);
+    value++;
+
+    nz_(value); // N, Z
 
-    (value & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (value == 0)   ? se_(0x02) : cl_(0x02); // Z
+    return value;
 }
 
-void jmp(uint8_t *location)
+void jmp(uint16_t location)
 {
     // Jump
-    programCounter = location - memory - 1;
+    programCounter = location - 1;
 }
 
-void jsr(uint8_t *location)
+void jsr(uint16_t location)
 {
     // Jump to subroutine
     ph_(programCounter >> 8);
     ph_(programCounter);
     jmp(location);
+    if (config::profile)
+        profiler::call(location);
 }
 
-void ld_(uint8_t *reg, uint8_t *src)
+uint8_t ld_(uint16_t src)
 {
-    // Load a register
-    *reg = memoryRead(src);
+    // Load a value into a register
+    uint8_t value = memoryRead(src);
+
+    nz_(value); // N, Z
 
-    (*reg & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (*reg == 0)   ? se_(0x02) : cl_(0x02); // Z
+    return value;
 }
 
-void lsr(uint8_t *dst)
+uint8_t lsr(uint8_t before)
 {
     // Logical shift right
-    uint8_t before = memoryRead(dst);
     uint8_t after = before >> 1;
-    memoryWrite(dst, after);
 
-    (after & 0x80)  ? se_(0x80) : cl_(0x80); // N
-    (after == 0)    ? se_(0x02) : cl_(0x02); // Z
+    nz_(after); // N, Z
     (before & 0x01) ? se_(0x01) : cl_(0x01); // C
+
+    return after;
 }
 
-void ora(uint8_t *src)
+void ora(uint16_t src)
 {
     // Bitwise or
     accumulator |= memoryRead(src);
 
-    (accumulator & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (accumulator == 0)   ? se_(0x02) : cl_(0x02); // Z
+    nz_(accumulator); // N, Z
 }
 
-void t__(uint8_t *src, uint8_t *dst)
+uint8_t t__(uint8_t value)
 {
-    // Transfer one register to another
-    *dst = *src;
+    // Transfer a value to a register
+    nz_(value); // N, Z
 
-    // Don't set flags when transferring to the stack pointer
-    if (dst == &stackPointer)
-        return;
+    return value;
+}
 
-    (*dst & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (*dst == 0)   ? se_(0x02) : cl_(0x02); // Z
+void plp()
+{
+    // Pull the flags from the stack
+    setFlags((pl_() | 0x20) & ~0x10); // B
 }
 
-void rol(uint8_t *dst)
+uint8_t rol(uint8_t before)
 {
     // Rotate left
-    uint8_t before = memoryRead(dst);
     uint8_t after = (before << 1) | (flags & 0x01);
-    memoryWrite(dst, after);
 
-    (after & 0x80)  ? se_(0x80) : cl_(0x80); // N
-    (after == 0)    ? se_(0x02) : cl_(0x02); // Z
+    nz_(after); // N, Z
     (before & 0x80) ? se_(0x01) : cl_(0x01); // C
+
+    return after;
 }
 
-void ror(uint8_t *dst)
+uint8_t ror(uint8_t before)
 {
     // Rotate right
-    uint8_t before = memoryRead(dst);
     uint8_t after = (before >> 1) | ((flags & 0x01) << 7);
-    memoryWrite(dst, after);
 
-    (after & 0x80)  ? se_(0x80) : cl_(0x80); // N
-    (after == 0)    ? se_(0x02) : cl_(0x02); // Z
+    nz_(after); // N, Z
     (before & 0x01) ? se_(0x01) : cl_(0x01); // C
+
+    return after;
 }
 
 void rts()
@@ -456,499 +893,511 @@ void rts()
     // Return from subroutine
     stackPointer += 2;
     programCounter = memory[0xFF + stackPointer] | (memory[0x100 + stackPointer] << 8);
+    if (pages[0x01].watched)
+    {
+        debugger::watchRead(0xFF + stackPointer, programCounter);
+        debugger::watchRead(0x100 + stackPointer, programCounter >> 8);
+    }
+    if (config::profile)
+        profiler::ret();
 }
 
 void rti()
 {
     // Return from interrupt
-    pl_(&flags);
+    plp();
     rts();
     programCounter--;
 }
 
-void sbc(uint8_t *src)
+void sbc(uint16_t src)
 {
     // Subtract with carry
-    uint8_t before = accumulator;
-    uint8_t value = memoryRead(src);
-    accumulator -= value + !(flags & 0x01);
+    subtractCarry(memoryRead(src));
+}
 
-    (accumulator & 0x80)                                                    ? se_(0x80) : cl_(0x80); // N
-    (accumulator == 0)                                                      ? se_(0x02) : cl_(0x02); // Z
-    ((value & 0x80) != (before & 0x80) && (flags & 0x80) == (value & 0x80)) ? se_(0x40) : cl_(0x40); // V
-    (before >= accumulator && value + !(flags & 0x01) != 0x100)             ? se_(0x01) : cl_(0x01); // C
+void stp()
+{
+    // Halt the CPU, dumping the trace of what led up to it
+    if (config::trace)
+        trace::jam();
 }
 
-void st_(uint8_t reg, uint8_t *dst)
+void st_(uint8_t reg, uint16_t dst)
 {
     // Store a register
     memoryWrite(dst, reg);
 }
 
-void ahx(uint8_t *dst)
+void ahx(uint16_t dst)
 {
     // Store the bitwise and of the accumulator, the X register and the high byte of the address plus one
-    memoryWrite(dst, accumulator & registerX & (memory[programCounter] + 1));
+    memoryWrite(dst, accumulator & registerX & (memoryRead(programCounter) + 1));
 }
 
-void alr(uint8_t *src)
+void alr(uint16_t src)
 {
     // Bitwise and and shift right
     _and(src);
-    lsr(&accumulator);
+    accumulator = lsr(accumulator);
 }
 
-void anc(uint8_t *src)
+void anc(uint16_t src)
 {
     // Bitwise and and set carry flag
     _and(src);
     (accumulator & 0x80) ? se_(0x01) : cl_(0x01); // C
 }
 
-void arr(uint8_t *src)
+void arr(uint16_t src)
 {
     // Bitwise and and rotate right
     _and(src);
-    ror(&accumulator);
+    accumulator = ror(accumulator);
 
     ((accumulator & 0x40) ^ ((accumulator & 0x20) << 1)) ? se_(0x40) : cl_(0x40); // V
     (accumulator & 0x40)                                 ? se_(0x01) : cl_(0x01); // C
 }
 
-void axs(uint8_t *src)
+void axs(uint16_t src)
 {
     // Store the bitwise and with the X register minus a value in the X register
     registerX &= accumulator;
     uint8_t before = registerX;
-    registerX -= *src;
+    registerX -= memoryRead(src);
 
-    (registerX & 0x80)    ? se_(0x80) : cl_(0x80); // N
-    (registerX == 0)      ? se_(0x02) : cl_(0x02); // Z
+    nz_(registerX); // N, Z
     (before >= registerX) ? se_(0x01) : cl_(0x01); // C
 }
 
-void dcp(uint8_t *src)
+void dcp(uint16_t src)
 {
     // Decrement and compare
-    de_(src);
+    rmw(src, de_);
     cp_(accumulator, src);
 }
 
-void isc(uint8_t *src)
+void isc(uint16_t src)
 {
     // Increment and subtract
-    in_(src);
+    rmw(src, in_);
     sbc(src);
 }
 
-void las(uint8_t *src)
+void las(uint16_t src)
 {
     // Bitwise and with the stack pointer and load multiple registers
-    uint8_t value = *src & stackPointer;
+    uint8_t value = memoryRead(src) & stackPointer;
     accumulator = value;
     registerX = value;
     stackPointer = value;
 
-    (value & 0x80) ? se_(0x80) : cl_(0x80); // N
-    (value == 0)   ? se_(0x02) : cl_(0x02); // Z
+    nz_(value); // N, Z
 }
 
-void lax(uint8_t *src)
+void lax(uint16_t src)
 {
     // Load the accumulator and the X register
-    ld_(&accumulator, src);
-    ld_(&registerX, src);
+    accumulator = ld_(src);
+    registerX = ld_(src);
 }
 
-void rla(uint8_t *src)
+void rla(uint16_t src)
 {
     // Rotate left and bitwise and
-    rol(src);
+    rmw(src, rol);
     _and(src);
 }
 
-void rra(uint8_t *src)
+void rra(uint16_t src)
 {
     // Rotate right and add
-    ror(src);
+    rmw(src, ror);
     adc(src);
 }
 
-void sax(uint8_t *dst)
+void sax(uint16_t dst)
 {
     // Bitwise and of the accumulator and the X register
     memoryWrite(dst, accumulator & registerX);
 }
 
-void shx(uint8_t *dst)
+void shx(uint16_t dst)
 {
     // Store the bitwise and of the X register and the high byte of the address plus one
-    memoryWrite(dst, registerX & (memory[programCounter] + 1));
+    memoryWrite(dst, registerX & (memoryRead(programCounter) + 1));
 }
 
-void shy(uint8_t *dst)
+void shy(uint16_t dst)
 {
     // Store the bitwise and of the Y register and the high byte of the address plus one
-    memoryWrite(dst, registerY & (memory[programCounter] + 1));
+    memoryWrite(dst, registerY & (memoryRead(programCounter) + 1));
 }
 
-void slo(uint8_t *src)
+void slo(uint16_t src)
 {
     // Shift left and bitwise or
-    asl(src);
+    rmw(src, asl);
     ora(src);
 }
 
-void sre(uint8_t *src)
+void sre(uint16_t src)
 {
     // Shift right and bitwise exclusive or
-    lsr(src);
+    rmw(src, lsr);
     eor(src);
 }
 
-void tas(uint8_t *dst)
+void tas(uint16_t dst)
 {
     // Store the bitwise and of the accumulator, the X register and the high byte of the address plus one
     stackPointer = (accumulator & registerX);
-    memoryWrite(dst, stackPointer & (memory[programCounter] + 1));
+    memoryWrite(dst, stackPointer & (memoryRead(programCounter) + 1));
 }
 
-void xaa(uint8_t *src)
+void xaa(uint16_t src)
 {
     // Transfer the X register to the accumulator and bitwise and
-    t__(&registerX, &accumulator);
+    accumulator = t__(registerX);
     _and(src);
 }
 
+template <Mode mode, bool pageCycle>
+uint16_t resolve(uint16_t operand)
+{
+    // Get the memory address of an operand; this folds to a single case for each handler
+    switch (mode)
+    {
+        case IMM: return programCounter; // The operand itself
+        case ZPG: return operand;
+        case ZPX: return zeroPageX(operand);
+        case ZPY: return zeroPageY(operand);
+        case ABS: return operand;
+        case ABX: return absoluteX(operand, pageCycle);
+        case ABY: return absoluteY(operand, pageCycle);
+        case IND: return indirect(operand);
+        case IZX: return indirectX(operand);
+        case IZY: return indirectY(operand, pageCycle);
+        case REL: return programCounter; // The branch offset
+        default:  return 0; // Implied or accumulator
+    }
+}
+
+template <Operation operation, Mode mode>
+void perform(uint16_t address)
+{
+    // Perform an operation on a resolved address; this folds to a single case for each handler
+    switch (operation)
+    {
+        case ADC: adc(address);                          break;
+        case AND: _and(address);                         break;
+        case ASL:
+            if (mode == ACC)
+                accumulator = asl(accumulator);
+            else
+                rmw(address, asl);
+            break;
+        case BCC: b__(!(flags & 0x01), address);         break;
+        case BCS: b__(flags & 0x01, address);            break;
+        case BEQ: b__(zero(), address);                  break;
+        case BIT: bit(address);                          break;
+        case BMI: b__(negative(), address);              break;
+        case BNE: b__(!zero(), address);                 break;
+        case BPL: b__(!negative(), address);             break;
+        case BRK: brk();                                 break;
+        case BVC: b__(!(flags & 0x40), address);         break;
+        case BVS: b__(flags & 0x40, address);            break;
+        case CLC: cl_(0x01);                             break;
+        case CLD: cl_(0x08);                             break;
+        case CLI: cl_(0x04);                             break;
+        case CLV: cl_(0x40);                             break;
+        case CMP: cp_(accumulator, address);             break;
+        case CPX: cp_(registerX, address);               break;
+        case CPY: cp_(registerY, address);               break;
+        case DEC: rmw(address, de_);                     break;
+        case DEX: registerX = de_(registerX);            break;
+        case DEY: registerY = de_(registerY);            break;
+        case EOR: eor(address);                          break;
+        case INC: rmw(address, in_);                     break;
+        case INX: registerX = in_(registerX);            break;
+        case INY: registerY = in_(registerY);            break;
+        case JMP: jmp(address);                          break;
+        case JSR: jsr(address);                          break;
+        case LDA: accumulator = ld_(address);            break;
+        case LDX: registerX = ld_(address);              break;
+        case LDY: registerY = ld_(address);              break;
+        case LSR:
+            if (mode == ACC)
+                accumulator = lsr(accumulator);
+            else
+                rmw(address, lsr);
+            break;
+        case NOP:                                        break;
+        case ORA: ora(address);                          break;
+        case PHA: ph_(accumulator);                      break;
+        case PHP: ph_(getFlags() | 0x10);                break;
+        case PLA: accumulator = t__(pl_());              break;
+        case PLP: plp();                                 break;
+        case ROL:
+            if (mode == ACC)
+                accumulator = rol(accumulator);
+            else
+                rmw(address, rol);
+            break;
+        case ROR:
+            if (mode == ACC)
+                accumulator = ror(accumulator);
+            else
+                rmw(address, ror);
+            break;
+        case RTI: rti();                                 break;
+        case RTS: rts();                                 break;
+        case SBC: sbc(address);                          break;
+        case SEC: se_(0x01);                             break;
+        case SED: se_(0x08);                             break;
+        case SEI: se_(0x04);                             break;
+        case STA: st_(accumulator, address);             break;
+        case STX: st_(registerX, address);               break;
+        case STY: st_(registerY, address);               break;
+        case TAX: registerX = t__(accumulator);          break;
+        case TAY: registerY = t__(accumulator);          break;
+        case TSX: registerX = t__(stackPointer);         break;
+        case TXA: accumulator = t__(registerX);          break;
+        case TXS: stackPointer = registerX;              break;
+        case TYA: accumulator = t__(registerY);          break;
+        case AHX: ahx(address);                          break;
+        case ALR: alr(address);                          break;
+        case ANC: anc(address);                          break;
+        case ARR: arr(address);                          break;
+        case AXS: axs(address);                          break;
+        case DCP: dcp(address);                          break;
+        case ISC: isc(address);                          break;
+        case LAS: las(address);                          break;
+        case LAX: lax(address);                          break;
+        case RLA: rla(address);                          break;
+        case RRA: rra(address);                          break;
+        case SAX: sax(address);                          break;
+        case SHX: shx(address);                          break;
+        case SHY: shy(address);                          break;
+        case SLO: slo(address);                          break;
+        case SRE: sre(address);                          break;
+        case STP: stp();                                 break;
+        case TAS: tas(address);                          break;
+        case XAA: xaa(address);                          break;
+    }
+}
+
+uint8_t instructionLength(uint8_t opcode)
+{
+    // Get the size of the instruction for an opcode
+    return length(opcodes[opcode].mode);
+}
+
+template <int opcode>
+void execute(uint16_t operand)
+{
+    // Run an instruction with its operand already fetched, specialized at compile time from its opcode table entry
+    programCounter += length(opcodes[opcode].mode) - 1;
+    perform<opcodes[opcode].operation, opcodes[opcode].mode>(
+        resolve<opcodes[opcode].mode, opcodes[opcode].pageCycle>(operand));
+    targetCycles += opcodes[opcode].cycles;
+
+    // Halt on STP by running it again on the next cycle
+    if (opcodes[opcode].operation != STP)
+        programCounter++;
+}
+
+template <int... opcodes>
+struct Sequence
+{
+    // A table of the handlers generated for a sequence of opcodes
+    static void (*const handlers[sizeof...(opcodes)])(uint16_t operand);
+};
+
+template <int... opcodes>
+void (*const Sequence<opcodes...>::handlers[sizeof...(opcodes)])(uint16_t operand) = { execute<opcodes>... };
+
+template <int count, int... opcodes>
+struct MakeSequence: MakeSequence<count - 1, count - 1, opcodes...> {};
+
+template <int... opcodes>
+struct MakeSequence<0, opcodes...>
+{
+    typedef Sequence<opcodes...> Type;
+};
+
+// The handler for every opcode, generated from the opcode table
+void (*const *handlers)(uint16_t operand) = MakeSequence<0x100>::Type::handlers;
+
+uint16_t fetchOperand(uint16_t address, uint8_t opcode)
+{
+    // Read the operand bytes that follow an opcode
+    switch (instructionLength(opcode))
+    {
+        case 2:  return memoryRead(address + 1);
+        case 3:  return memoryRead(address + 1) | (memoryRead(address + 2) << 8);
+        default: return 0;
+    }
+}
+
+void decode(uint16_t address)
+{
+    // Decode an instruction into the cache, unless part of it lies outside of directly-backed memory
+    uint8_t opcode = memoryRead(address);
+    uint16_t end = address + instructionLength(opcode) - 1;
+    if (!pages[address >> 8].read || !pages[end >> 8].read)
+    {
+        handlers[opcode](fetchOperand(address, opcode));
+        return;
+    }
+
+    Decoded *entry = &decoded[address];
+    entry->handler = handlers[opcode];
+    entry->operand = fetchOperand(address, opcode);
+    entry->generation = generations[address >> 8];
+    markCode(address >> 8);
+    markCode(end >> 8);
+    entry->handler(entry->operand);
+}
+
+
+void runInstruction()
+{
+    // Decode and run the instruction at the program counter from memory
+    uint8_t opcode = memoryRead(programCounter);
+    handlers[opcode](fetchOperand(programCounter, opcode));
+}
+
 void runCycle()
 {
     // Only run on a CPU cycle (3 global cycles)
     if (core::globalCycles % 3 != 0)
         return;
 
-    // Wait until the previous instruction's cycles have finished
-    if (++cycles < targetCycles)
+    // Wait until the previous instruction's cycles have finished, or until something ends an idle loop skip
+    if (++cycles < targetCycles && !(idleState == IDLE_SKIPPING && idleInterrupted()))
         return;
 
+    // Stop at a breakpoint, or after a step or watchpoint hit, leaving the boundary to be taken again on resume
+    if (debugger::breakpointAt(programCounter) && debugger::check())
+    {
+        cycles--;
+        return;
+    }
+
+    // Finish a DMA transfer along with the stall it's part of
+    syncDma();
+
+    uint16_t lastCycles = targetCycles;
     cycles = targetCycles = 0;
 
-    // Disable IRQs if the inhibit flag is set
-    if (interrupts[2] && (flags & 0x04))
-        interrupts[2] = false;
+    // Count the time of the last instruction, interrupt or skip for the trace and the profiler
+    if (config::trace)
+        trace::cycles += lastCycles;
+    if (config::profile)
+        profiler::count(lastCycles);
 
-    // Handle interrupts
-    for (int i = 0; i < 3; i++)
+    // Handle the highest-priority interrupt that can be taken
+    if (uint8_t pending = pendingInterrupts())
     {
-        if (interrupts[i])
-        {
-            ph_(programCounter >> 8);
-            ph_(programCounter);
-            ph_(flags);
-            se_(0x04); // I
-            programCounter = (memory[0xFFFB + i * 2] << 8) | memory[0xFFFA + i * 2];
-            targetCycles += 7;
-            interrupts[i] = false;
-            return;
-        }
+        int i = (pending & INT_NMI) ? 0 : (pending & INT_RST) ? 1 : 2;
+        ph_(programCounter >> 8);
+        ph_(programCounter);
+        ph_(getFlags());
+        se_(0x04); // I
+        programCounter = (memoryRead(0xFFFB + i * 2) << 8) | memoryRead(0xFFFA + i * 2);
+        targetCycles += 7;
+
+        // Profile interrupt handlers as calls, except for reset, which starts the top level
+        if (config::profile && i != 1)
+            profiler::call(programCounter);
+
+        // NMI and reset are taken once, while IRQs stay asserted until their sources acknowledge them
+        if (i < 2)
+            interrupts &= ~(1 << i);
+        idleState = IDLE_OFF;
+        return;
+    }
+
+    // Skip through an idle loop, or learn whether the current loop is one
+    if (idleState != IDLE_OFF && idleStep(lastCycles))
+        return;
+
+    // Record the instruction in the trace and the code/data log, running it through the interpreter so that none are hidden in compiled code
+    // The interpreter is also used while the debugger could stop at any instruction
+    if (config::trace || config::codeLog || debugger::active)
+    {
+        if (config::trace)
+            trace::record();
+        if (config::codeLog)
+            cdl::execute();
+    }
+
+    // Run a recompiled routine if one was built in for this address and bank
+    else if (config::recompiled && aot::execute())
+        return;
+
+    // Run a compiled block if the JIT has one for this address
+    else if (config::jit && jit::execute())
+        return;
+
+    if (config::decodeCache)
+    {
+        // Run the instruction from the decode cache, decoding it first if the entry is stale
+        Decoded *entry = &decoded[programCounter];
+        if (entry->generation == generations[programCounter >> 8])
+            entry->handler(entry->operand);
+        else
+            decode(programCounter);
+    }
+    else
+    {
+        runInstruction();
+    }
+}
+
+string disassemble(uint16_t address)
+{
+    // Format the instruction at an address as it is in memory now
+    return disassemble(address, memoryPeek(address), memoryPeek(address + 1), memoryPeek(address + 2));
+}
+
+string disassemble(uint16_t address, uint8_t code, uint8_t value, uint8_t high)
+{
+    // Format an instruction from its bytes using the opcode table
+    const Opcode *opcode = &opcodes[code];
+    uint16_t word = value | (high << 8);
+    char operand[16];
+
+    switch (opcode->mode)
+    {
+        case IMP: return opcode->mnemonic;
+        case ACC: sprintf(operand, "A");                                      break;
+        case IMM: sprintf(operand, "#$%02X", value);                         break;
+        case ZPG: sprintf(operand, "$%02X", value);                          break;
+        case ZPX: sprintf(operand, "$%02X,X", value);                        break;
+        case ZPY: sprintf(operand, "$%02X,Y", value);                        break;
+        case ABS: sprintf(operand, "$%04X", word);                           break;
+        case ABX: sprintf(operand, "$%04X,X", word);                         break;
+        case ABY: sprintf(operand, "$%04X,Y", word);                         break;
+        case IND: sprintf(operand, "($%04X)", word);                         break;
+        case IZX: sprintf(operand, "($%02X,X)", value);                      break;
+        case IZY: sprintf(operand, "($%02X),Y", value);                      break;
+        case REL: sprintf(operand, "$%04X", (uint16_t)(address + 2 + (int8_t)value)); break;
     }
 
-    // Decode opcode
-    switch (memory[programCounter])
-    {
-        case 0x00: brk();                targetCycles += 7; break; // BRK
-        case 0x04: zeroPage();           targetCycles += 3; break; // NOP d
-        case 0x08: ph_(flags | 0x10);    targetCycles += 3; break; // PHP
-        case 0x0C: absolute();           targetCycles += 4; break; // NOP a
-        case 0x10: b__(!(flags & 0x80)); targetCycles += 2; break; // BPL *+d
-        case 0x14: zeroPageX();          targetCycles += 4; break; // NOP d,x
-        case 0x18: cl_(0x01);            targetCycles += 2; break; // CLC
-        case 0x1C: absoluteX(true);      targetCycles += 4; break; // NOP a,x
-
-        case 0x01: ora(indirectX());     targetCycles += 6; break; // ORA (d,x)
-        case 0x05: ora(zeroPage());      targetCycles += 3; break; // ORA d
-        case 0x09: ora(immediate());     targetCycles += 2; break; // ORA #i
-        case 0x0D: ora(absolute());      targetCycles += 4; break; // ORA a
-        case 0x11: ora(indirectY(true)); targetCycles += 5; break; // ORA (d),y
-        case 0x15: ora(zeroPageX());     targetCycles += 4; break; // ORA d,x
-        case 0x19: ora(absoluteY(true)); targetCycles += 4; break; // ORA a,y
-        case 0x1D: ora(absoluteX(true)); targetCycles += 4; break; // ORA a,x
-
-        case 0x02: return;                                          // STP
-        case 0x06: asl(zeroPage());       targetCycles += 5; break; // ASL d
-        case 0x0A: asl(&accumulator);     targetCycles += 2; break; // ASL
-        case 0x0E: asl(absolute());       targetCycles += 6; break; // ASL a
-        case 0x12: return;                                          // STP
-        case 0x16: asl(zeroPageX());      targetCycles += 6; break; // ASL d,x
-        case 0x1A:                        targetCycles += 2; break; // NOP
-        case 0x1E: asl(absoluteX(false)); targetCycles += 7; break; // ASL a,x
-
-        case 0x03: slo(indirectX());      targetCycles += 8; break; // SLO (d,x)
-        case 0x07: slo(zeroPage());       targetCycles += 5; break; // SLO d
-        case 0x0B: anc(immediate());      targetCycles += 2; break; // ANC #i
-        case 0x0F: slo(absolute());       targetCycles += 6; break; // SLO a
-        case 0x13: slo(indirectY(false)); targetCycles += 8; break; // SLO (d),y
-        case 0x17: slo(zeroPageX());      targetCycles += 6; break; // SLO d,x
-        case 0x1B: slo(absoluteY(false)); targetCycles += 7; break; // SLO a,y
-        case 0x1F: slo(absoluteX(false)); targetCycles += 7; break; // SLO a,x
-
-        case 0x20: jsr(absolute());      targetCycles += 6; break; // JSR a
-        case 0x24: bit(zeroPage());      targetCycles += 3; break; // BIT d
-        case 0x28: pl_(&flags);          targetCycles += 4; break; // PLP
-        case 0x2C: bit(absolute());      targetCycles += 4; break; // BIT a
-        case 0x30: b__( (flags & 0x80)); targetCycles += 2; break; // BMI *+d
-        case 0x34: zeroPageX();          targetCycles += 4; break; // NOP d,x
-        case 0x38: se_(0x01);            targetCycles += 2; break; // SEC
-        case 0x3C: absoluteX(true);      targetCycles += 4; break; // NOP a,x
-
-        case 0x21: _and(indirectX());     targetCycles += 6; break; // AND (d,x)
-        case 0x25: _and(zeroPage());      targetCycles += 3; break; // AND d
-        case 0x29: _and(immediate());     targetCycles += 2; break; // AND #i
-        case 0x2D: _and(absolute());      targetCycles += 4; break; // AND a
-        case 0x31: _and(indirectY(true)); targetCycles += 5; break; // AND (d),y
-        case 0x35: _and(zeroPageX());     targetCycles += 4; break; // AND d,x
-        case 0x39: _and(absoluteY(true)); targetCycles += 4; break; // AND a,y
-        case 0x3D: _and(absoluteX(true)); targetCycles += 4; break; // AND a,x
-
-        case 0x22: return;                                          // STP
-        case 0x26: rol(zeroPage());       targetCycles += 5; break; // ROL d
-        case 0x2A: rol(&accumulator);     targetCycles += 2; break; // ROL
-        case 0x2E: rol(absolute());       targetCycles += 6; break; // ROL a
-        case 0x32: return;                                          // STP
-        case 0x36: rol(zeroPageX());      targetCycles += 6; break; // ROL d,x
-        case 0x3A:                        targetCycles += 2; break; // NOP
-        case 0x3E: rol(absoluteX(false)); targetCycles += 7; break; // ROL a,x
-
-        case 0x23: rla(indirectX());      targetCycles += 8; break; // RLA (d,x)
-        case 0x27: rla(zeroPage());       targetCycles += 5; break; // RLA d
-        case 0x2B: anc(immediate());      targetCycles += 2; break; // ANC #i
-        case 0x2F: rla(absolute());       targetCycles += 6; break; // RLA a
-        case 0x33: rla(indirectY(false)); targetCycles += 8; break; // RLA (d),y
-        case 0x37: rla(zeroPageX());      targetCycles += 6; break; // RLA d,x
-        case 0x3B: rla(absoluteY(false)); targetCycles += 7; break; // RLA a,y
-        case 0x3F: rla(absoluteX(false)); targetCycles += 7; break; // RLA a,x
-
-        case 0x40: rti();                targetCycles += 6; break; // RTI
-        case 0x44: zeroPage();           targetCycles += 3; break; // NOP d
-        case 0x48: ph_(accumulator);     targetCycles += 3; break; // PHA
-        case 0x4C: jmp(absolute());      targetCycles += 3; break; // JMP a
-        case 0x50: b__(!(flags & 0x40)); targetCycles += 2; break; // BVC *+d
-        case 0x54: zeroPageX();          targetCycles += 4; break; // NOP d,x
-        case 0x58: cl_(0x04);            targetCycles += 2; break; // CLI
-        case 0x5C: absoluteX(true);      targetCycles += 4; break; // NOP a,x
-
-        case 0x41: eor(indirectX());     targetCycles += 6; break; // EOR (d,x)
-        case 0x45: eor(zeroPage());      targetCycles += 3; break; // EOR d
-        case 0x49: eor(immediate());     targetCycles += 2; break; // EOR #i
-        case 0x4D: eor(absolute());      targetCycles += 4; break; // EOR a
-        case 0x51: eor(indirectY(true)); targetCycles += 5; break; // EOR (d),y
-        case 0x55: eor(zeroPageX());     targetCycles += 4; break; // EOR d,x
-        case 0x59: eor(absoluteY(true)); targetCycles += 4; break; // EOR a,y
-        case 0x5D: eor(absoluteX(true)); targetCycles += 4; break; // EOR a,x
-
-        case 0x42: return;                                          // STP
-        case 0x46: lsr(zeroPage());       targetCycles += 5; break; // LSR d
-        case 0x4A: lsr(&accumulator);     targetCycles += 2; break; // LSR
-        case 0x4E: lsr(absolute());       targetCycles += 6; break; // LSR a
-        case 0x52: return;                                          // STP
-        case 0x56: lsr(zeroPageX());      targetCycles += 6; break; // LSR d,x
-        case 0x5A:                        targetCycles += 2; break; // NOP
-        case 0x5E: lsr(absoluteX(false)); targetCycles += 7; break; // LSR a,x
-
-        case 0x43: sre(indirectX());      targetCycles += 8; break; // SRE (d,x)
-        case 0x47: sre(zeroPage());       targetCycles += 5; break; // SRE d
-        case 0x4B: alr(immediate());      targetCycles += 2; break; // ALR #i
-        case 0x4F: sre(absolute());       targetCycles += 6; break; // SRE a
-        case 0x53: sre(indirectY(false)); targetCycles += 8; break; // SRE (d),y
-        case 0x57: sre(zeroPageX());      targetCycles += 6; break; // SRE d,x
-        case 0x5B: sre(absoluteY(false)); targetCycles += 7; break; // SRE a,y
-        case 0x5F: sre(absoluteX(false)); targetCycles += 7; break; // SRE a,x
-
-        case 0x60: rts();                targetCycles += 6; break; // RTS
-        case 0x64: zeroPage();           targetCycles += 3; break; // NOP d
-        case 0x68: pl_(&accumulator);    targetCycles += 4; break; // PLA
-        case 0x6C: jmp(indirect());      targetCycles += 5; break; // JMP (a)
-        case 0x70: b__( (flags & 0x40)); targetCycles += 2; break; // BVS *+d
-        case 0x74: zeroPageX();          targetCycles += 4; break; // NOP d,x
-        case 0x78: se_(0x04);            targetCycles += 2; break; // SEI
-        case 0x7C: absoluteX(true);      targetCycles += 4; break; // NOP a,x
-
-        case 0x61: adc(indirectX());     targetCycles += 6; break; // ADC (d,x)
-        case 0x65: adc(zeroPage());      targetCycles += 3; break; // ADC d
-        case 0x69: adc(immediate());     targetCycles += 2; break; // ADC #i
-        case 0x6D: adc(absolute());      targetCycles += 4; break; // ADC a
-        case 0x71: adc(indirectY(true)); targetCycles += 5; break; // ADC (d),y
-        case 0x75: adc(zeroPageX());     targetCycles += 4; break; // ADC d,x
-        case 0x79: adc(absoluteY(true)); targetCycles += 4; break; // ADC a,y
-        case 0x7D: adc(absoluteX(true)); targetCycles += 4; break; // ADC a,x
-
-        case 0x62: return;                                          // STP
-        case 0x66: ror(zeroPage());       targetCycles += 5; break; // ROR d
-        case 0x6A: ror(&accumulator);     targetCycles += 2; break; // ROR
-        case 0x6E: ror(absolute());       targetCycles += 6; break; // ROR a
-        case 0x72: return;                                          // STP
-        case 0x76: ror(zeroPageX());      targetCycles += 6; break; // ROR d,x
-        case 0x7A:                        targetCycles += 2; break; // NOP
-        case 0x7E: ror(absoluteX(false)); targetCycles += 7; break; // ROR a,x
-
-        case 0x63: rra(indirectX());      targetCycles += 8; break; // RRA (d,x)
-        case 0x67: rra(zeroPage());       targetCycles += 5; break; // RRA d
-        case 0x6B: arr(immediate());      targetCycles += 2; break; // ARR #i
-        case 0x6F: rra(absolute());       targetCycles += 6; break; // RRA a
-        case 0x73: rra(indirectY(false)); targetCycles += 8; break; // RRA (d),y
-        case 0x77: rra(zeroPageX());      targetCycles += 6; break; // RRA d,x
-        case 0x7B: rra(absoluteY(false)); targetCycles += 7; break; // RRA a,y
-        case 0x7F: rra(absoluteX(false)); targetCycles += 7; break; // RRA a,x
-
-        case 0x80: immediate();                   targetCycles += 2; break; // NOP #i
-        case 0x84: st_(registerY, zeroPage());    targetCycles += 3; break; // STY d
-        case 0x88: de_(&registerY);               targetCycles += 2; break; // DEY
-        case 0x8C: st_(registerY, absolute());    targetCycles += 4; break; // STY a
-        case 0x90: b__(!(flags & 0x01));          targetCycles += 2; break; // BCC *+d
-        case 0x94: st_(registerY, zeroPageX());   targetCycles += 4; break; // STY d,x
-        case 0x98: t__(&registerY, &accumulator); targetCycles += 2; break; // TYA
-        case 0x9C: shy(absoluteX(false));         targetCycles += 5; break; // SHY a,x
-
-        case 0x81: st_(accumulator, indirectX());      targetCycles += 6; break; // STA (d,x)
-        case 0x85: st_(accumulator, zeroPage());       targetCycles += 3; break; // STA d
-        case 0x89: immediate();                        targetCycles += 2; break; // NOP #i
-        case 0x8D: st_(accumulator, absolute());       targetCycles += 4; break; // STA a
-        case 0x91: st_(accumulator, indirectY(false)); targetCycles += 6; break; // STA (d),y
-        case 0x95: st_(accumulator, zeroPageX());      targetCycles += 4; break; // STA d,x
-        case 0x99: st_(accumulator, absoluteY(false)); targetCycles += 5; break; // STA a,y
-        case 0x9D: st_(accumulator, absoluteX(false)); targetCycles += 5; break; // STA a,x
-
-        case 0x82: immediate();                    targetCycles += 2; break; // NOP #i
-        case 0x86: st_(registerX, zeroPage());     targetCycles += 3; break; // STX d
-        case 0x8A: t__(&registerX, &accumulator);  targetCycles += 2; break; // TXA
-        case 0x8E: st_(registerX, absolute());     targetCycles += 4; break; // STX a
-        case 0x92: return;                                                   // STP
-        case 0x96: st_(registerX, zeroPageY());    targetCycles += 4; break; // STX d,y
-        case 0x9A: t__(&registerX, &stackPointer); targetCycles += 2; break; // TXS
-        case 0x9E: shx(absoluteY(false));          targetCycles += 5; break; // SHX a,y
-
-        case 0x83: sax(indirectX());      targetCycles += 6; break; // SAX (d,x)
-        case 0x87: sax(zeroPage());       targetCycles += 3; break; // SAX d
-        case 0x8B: xaa(immediate());      targetCycles += 2; break; // XAA #i
-        case 0x8F: sax(absolute());       targetCycles += 4; break; // SAX a
-        case 0x93: ahx(indirectY(false)); targetCycles += 6; break; // AHX (d),y
-        case 0x97: sax(zeroPageY());      targetCycles += 4; break; // SAX d,y
-        case 0x9B: tas(absoluteY(false)); targetCycles += 5; break; // TAS a,y
-        case 0x9F: ahx(absoluteY(false)); targetCycles += 5; break; // AHX a,y
-
-        case 0xA0: ld_(&registerY, immediate());     targetCycles += 2; break; // LDY #i
-        case 0xA4: ld_(&registerY, zeroPage());      targetCycles += 3; break; // LDY d
-        case 0xA8: t__(&accumulator, &registerY);    targetCycles += 2; break; // TAY
-        case 0xAC: ld_(&registerY, absolute());      targetCycles += 4; break; // LDY a
-        case 0xB0: b__( (flags & 0x01));             targetCycles += 2; break; // BCS *+d
-        case 0xB4: ld_(&registerY, zeroPageX());     targetCycles += 4; break; // LDY d,x
-        case 0xBC: ld_(&registerY, absoluteX(true)); targetCycles += 4; break; // LDY a,x
-        case 0xB8: cl_(0x40);                        targetCycles += 2; break; // CLV
-
-        case 0xA1: ld_(&accumulator, indirectX());     targetCycles += 6; break; // LDA (d,x)
-        case 0xA5: ld_(&accumulator, zeroPage());      targetCycles += 3; break; // LDA d
-        case 0xA9: ld_(&accumulator, immediate());     targetCycles += 2; break; // LDA #i
-        case 0xAD: ld_(&accumulator, absolute());      targetCycles += 4; break; // LDA a
-        case 0xB1: ld_(&accumulator, indirectY(true)); targetCycles += 5; break; // LDA (d),y
-        case 0xB5: ld_(&accumulator, zeroPageX());     targetCycles += 4; break; // LDA d,x
-        case 0xB9: ld_(&accumulator, absoluteY(true)); targetCycles += 4; break; // LDA a,y
-        case 0xBD: ld_(&accumulator, absoluteX(true)); targetCycles += 4; break; // LDA a,x
-
-        case 0xA2: ld_(&registerX, immediate());     targetCycles += 2; break; // LDX #i
-        case 0xA6: ld_(&registerX, zeroPage());      targetCycles += 3; break; // LDX d
-        case 0xAA: t__(&accumulator, &registerX);    targetCycles += 2; break; // TAX
-        case 0xAE: ld_(&registerX, absolute());      targetCycles += 4; break; // LDX a
-        case 0xB2: return;                                                     // STP
-        case 0xBA: t__(&stackPointer, &registerX);   targetCycles += 2; break; // TSX
-        case 0xB6: ld_(&registerX, zeroPageY());     targetCycles += 4; break; // LDX d,y
-        case 0xBE: ld_(&registerX, absoluteY(true)); targetCycles += 4; break; // LDX a,y
-
-        case 0xA3: lax(indirectX());     targetCycles += 6; break; // LAX (d,x)
-        case 0xA7: lax(zeroPage());      targetCycles += 3; break; // LAX d
-        case 0xAB: lax(immediate());     targetCycles += 2; break; // LAX #i
-        case 0xAF: lax(absolute());      targetCycles += 4; break; // LAX a
-        case 0xB3: lax(indirectY(true)); targetCycles += 5; break; // LAX (d),y
-        case 0xB7: lax(zeroPageY());     targetCycles += 4; break; // LAX d,y
-        case 0xBB: las(absoluteY(true)); targetCycles += 4; break; // LAS a,y
-        case 0xBF: lax(absoluteY(true)); targetCycles += 4; break; // LAX a,y
-
-        case 0xC0: cp_(registerY, immediate()); targetCycles += 2; break; // CPY #i
-        case 0xC4: cp_(registerY, zeroPage());  targetCycles += 3; break; // CPY d
-        case 0xC8: in_(&registerY);             targetCycles += 2; break; // INY
-        case 0xCC: cp_(registerY, absolute());  targetCycles += 4; break; // CPY a
-        case 0xD0: b__(!(flags & 0x02));        targetCycles += 2; break; // BNE *+d
-        case 0xD4: zeroPageX();                 targetCycles += 4; break; // NOP d,x
-        case 0xD8: cl_(0x08);                   targetCycles += 2; break; // CLD
-        case 0xDC: absoluteX(true);             targetCycles += 4; break; // NOP a,x
-
-        case 0xC1: cp_(accumulator, indirectX());     targetCycles += 6; break; // CMP (d,x)
-        case 0xC5: cp_(accumulator, zeroPage());      targetCycles += 3; break; // CMP d
-        case 0xC9: cp_(accumulator, immediate());     targetCycles += 2; break; // CMP #i
-        case 0xCD: cp_(accumulator, absolute());      targetCycles += 4; break; // CMP a
-        case 0xD1: cp_(accumulator, indirectY(true)); targetCycles += 5; break; // CMP (d),y
-        case 0xD5: cp_(accumulator, zeroPageX());     targetCycles += 4; break; // CMP d,x
-        case 0xD9: cp_(accumulator, absoluteY(true)); targetCycles += 4; break; // CMP a,y
-        case 0xDD: cp_(accumulator, absoluteX(true)); targetCycles += 4; break; // CMP a,x
-
-        case 0xC2: immediate();           targetCycles += 2; break; // NOP #i
-        case 0xC6: de_(zeroPage());       targetCycles += 5; break; // DEC d
-        case 0xCA: de_(&registerX);       targetCycles += 2; break; // DEX
-        case 0xCE: de_(absolute());       targetCycles += 6; break; // DEC a
-        case 0xD2: return;                                          // STP
-        case 0xD6: de_(zeroPageX());      targetCycles += 6; break; // DEC d,x
-        case 0xDA:                        targetCycles += 2; break; // NOP
-        case 0xDE: de_(absoluteX(false)); targetCycles += 7; break; // DEC a,x
-
-        case 0xC3: dcp(indirectX());      targetCycles += 8; break; // DCP (d,x)
-        case 0xC7: dcp(zeroPage());       targetCycles += 5; break; // DCP d
-        case 0xCB: axs(immediate());      targetCycles += 2; break; // AXS #i
-        case 0xCF: dcp(absolute());       targetCycles += 6; break; // DCP a
-        case 0xD3: dcp(indirectY(false)); targetCycles += 8; break; // DCP (d),y
-        case 0xD7: dcp(zeroPageX());      targetCycles += 6; break; // DCP d,x
-        case 0xDB: dcp(absoluteY(false)); targetCycles += 7; break; // DCP a,y
-        case 0xDF: dcp(absoluteX(false)); targetCycles += 7; break; // DCP a,x
-
-        case 0xE0: cp_(registerX, immediate()); targetCycles += 2; break; // CPX #i
-        case 0xE4: cp_(registerX, zeroPage());  targetCycles += 3; break; // CPX d
-        case 0xE8: in_(&registerX);             targetCycles += 2; break; // INX
-        case 0xEC: cp_(registerX, absolute());  targetCycles += 4; break; // CPX a
-        case 0xF0: b__( (flags & 0x02));        targetCycles += 2; break; // BEQ *+d
-        case 0xF4: zeroPageX();                 targetCycles += 4; break; // NOP d,x
-        case 0xF8: se_(0x08);                   targetCycles += 2; break; // SED
-        case 0xFC: absoluteX(true);             targetCycles += 4; break; // NOP a,x
-
-        case 0xE1: sbc(indirectX());     targetCycles += 6; break; // SBC (d,x)
-        case 0xE5: sbc(zeroPage());      targetCycles += 3; break; // SBC d
-        case 0xE9: sbc(immediate());     targetCycles += 2; break; // SBC #i
-        case 0xED: sbc(absolute());      targetCycles += 4; break; // SBC a
-        case 0xF1: sbc(indirectY(true)); targetCycles += 5; break; // SBC (d),y
-        case 0xF5: sbc(zeroPageX());     targetCycles += 4; break; // SBC d,x
-        case 0xF9: sbc(absoluteY(true)); targetCycles += 4; break; // SBC a,y
-        case 0xFD: sbc(absoluteX(true)); targetCycles += 4; break; // SBC a,x
-
-        case 0xE2: immediate();           targetCycles += 2; break; // NOP #i
-        case 0xE6: in_(zeroPage());       targetCycles += 5; break; // INC d
-        case 0xEA:                        targetCycles += 2; break; // NOP
-        case 0xEE: in_(absolute());       targetCycles += 6; break; // INC a
-        case 0xF2: return;                                          // STP
-        case 0xF6: in_(zeroPageX());      targetCycles += 6; break; // INC d,x
-        case 0xFA:                        targetCycles += 2; break; // NOP
-        case 0xFE: in_(absoluteX(false)); targetCycles += 7; break; // INC a,x
-
-        case 0xE3: isc(indirectX());      targetCycles += 8; break; // ISC (d,x)
-        case 0xE7: isc(zeroPage());       targetCycles += 5; break; // ISC d
-        case 0xEB: sbc(immediate());      targetCycles += 2; break; // SBC #i
-        case 0xEF: isc(absolute());       targetCycles += 6; break; // ISC a
-        case 0xF3: isc(indirectY(false)); targetCycles += 8; break; // ISC (d),y
-        case 0xF7: isc(zeroPageX());      targetCycles += 6; break; // ISC d,x
-        case 0xFB: isc(absoluteY(false)); targetCycles += 7; break; // ISC a,y
-        case 0xFF: isc(absoluteX(false)); targetCycles += 7; break; // ISC a,x
-    }
-
-    programCounter++;
+    return string(opcode->mnemonic) + " " + operand;
 }
 
 void saveState(FILE *state)
 {
+    // End a skip at the next loop boundary, so that the state is exact
+    if (idleState == IDLE_SKIPPING)
+        idleStop(cycles + 1);
+
+    // Fold the lazily-kept N and Z flags into the status byte
+    getFlags();
+
     for (unsigned int i = 0; i < stateItems.size(); i++)
         fwrite(stateItems[i].pointer, 1, stateItems[i].size, state);
 }
@@ -957,6 +1406,15 @@ void loadState(FILE *state)
 {
     for (unsigned int i = 0; i < stateItems.size(); i++)
         fread(stateItems[i].pointer, 1, stateItems[i].size, state);
+
+    // Rebuild the lazily-kept N and Z flags from the status byte
+    setFlags(flags);
+
+    // Discard decoded instructions and idle loop tracking, since memory has changed
+    for (int i = 0; i < 0x100; i++)
+        invalidate(i);
+    idleState = IDLE_OFF;
+    idleRejected = 0;
 }
 
 }
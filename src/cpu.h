@@ -23,14 +23,124 @@
 namespace cpu
 {
 
+// Pending interrupt bits; each IRQ source holds its bit until it acknowledges the IRQ
+enum Interrupt
+{
+    INT_NMI   = 0x01,
+    INT_RST   = 0x02,
+    IRQ_FRAME = 0x04, // APU frame counter
+    IRQ_MMC3  = 0x08  // MMC3 scanline counter
+};
+
+const uint8_t IRQ_MASK = IRQ_FRAME | IRQ_MMC3;
+
+typedef struct
+{
+    uint8_t *read;
+    uint8_t *write;
+    uint8_t (*readHandler)(uint16_t address);
+    void (*writeHandler)(uint16_t address, uint8_t value);
+    bool code; // Holds decoded instructions
+    bool watched; // Holds debugger watchpoints
+} Page;
+
 extern uint8_t memory[0x10000];
-extern bool interrupts[3];
+extern Page pages[0x100];
+extern uint32_t generations[0x100];
+
+extern uint16_t targetCycles;
+extern uint16_t programCounter;
+extern uint8_t accumulator, registerX, registerY;
+extern uint8_t flags;
+extern uint16_t nzResult;
+extern uint8_t stackPointer;
+extern uint8_t interrupts;
 
 extern uint8_t inputMasks[2];
+extern bool inputPolled;
+
+extern void (*const *handlers)(uint16_t operand);
+
+inline bool negative()
+{
+    // Derive the N flag from the last result, or from bit 15 when it was set separately
+    return (nzResult | (nzResult >> 8)) & 0x80;
+}
+
+inline bool zero()
+{
+    // Derive the Z flag from the last result
+    return !(nzResult & 0xFF);
+}
+
+inline uint8_t getFlags()
+{
+    // Fold the N and Z flags into the status byte
+    flags = (flags & 0x7D) | (negative() ? 0x80 : 0x00) | (zero() ? 0x02 : 0x00);
+    return flags;
+}
+
+inline void setFlags(uint8_t value)
+{
+    // Set the status byte, keeping a result that gives back its N and Z flags
+    flags = value;
+    nzResult = (value & 0x02) ? ((value & 0x80) << 8) : ((value & 0x80) | 0x01);
+}
+
+inline void addCarry(uint8_t value)
+{
+    // Add a value and the carry to the accumulator, setting N, Z, V and C
+    uint8_t before = accumulator;
+    uint8_t carry = flags & 0x01;
+    accumulator += value + carry;
+    nzResult = accumulator;
+    bool overflow = (value & 0x80) == (before & 0x80) && (accumulator & 0x80) != (value & 0x80);
+    bool carryOut = before > accumulator || value + carry == 0x100;
+    flags = (flags & 0xBE) | (overflow ? 0x40 : 0x00) | (carryOut ? 0x01 : 0x00);
+}
+
+inline void subtractCarry(uint8_t value)
+{
+    // Subtract a value and the borrow from the accumulator, setting N, Z, V and C
+    uint8_t before = accumulator;
+    uint8_t borrow = !(flags & 0x01);
+    accumulator -= value + borrow;
+    nzResult = accumulator;
+    bool overflow = (value & 0x80) != (before & 0x80) && (accumulator & 0x80) == (value & 0x80);
+    bool carryOut = before >= accumulator && value + borrow != 0x100;
+    flags = (flags & 0xBE) | (overflow ? 0x40 : 0x00) | (carryOut ? 0x01 : 0x00);
+}
+
+inline void compare(uint8_t reg, uint8_t value)
+{
+    // Compare a register to a value, setting N, Z and C
+    nzResult = (uint8_t)(reg - value);
+    flags = (flags & 0xFE) | ((reg >= value) ? 0x01 : 0x00);
+}
+
+void assertNmi();
+void assertIrq(uint8_t source);
+void acknowledgeIrq(uint8_t source);
+uint8_t pendingInterrupts();
+uint16_t eventCycles();
+uint16_t waitingCycles();
+void waitCycles(uint16_t count);
 
 void reset();
+void runInstruction();
 void runCycle();
 
+uint8_t memoryRead(uint16_t address);
+void memoryWrite(uint16_t address, uint8_t value);
+uint8_t memoryPeek(uint16_t address);
+void mapPrg(uint16_t address, uint8_t *data, uint32_t size);
+void markCode(uint8_t page);
+void syncDma();
+
+string disassemble(uint16_t address);
+string disassemble(uint16_t address, uint8_t code, uint8_t value, uint8_t high);
+uint8_t instructionLength(uint8_t opcode);
+
 void saveState(FILE *state);
 void loadState(FILE *state);
 
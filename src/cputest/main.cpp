@@ -0,0 +1,529 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// A correctness and benchmark tool for the CPU core, which steps cpu::runCycle one instruction at a time
+// Usage: noies-cputest [iterations]
+// Every vector is checked through the interpreter and the decode cache, then each opcode is timed through both
+// The vectors pin down the core's current behavior, including that of the unstable unofficial opcodes; the
+// JIT and recompiled code are checked against the interpreter by their own verify modes instead
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../core.h"
+#include "../config.h"
+#include "../cpu.h"
+#include "../opcodes.h"
+
+using namespace cpu;
+
+namespace cputest
+{
+
+typedef struct
+{
+    uint16_t address;
+    uint8_t value;
+} Byte;
+
+typedef struct
+{
+    uint16_t programCounter;
+    uint8_t accumulator, registerX, registerY, flags, stackPointer;
+    Byte memory[4]; // Unused entries are left at address 0
+} State;
+
+typedef struct
+{
+    uint8_t code[3];
+    State initial;
+    State final; // Only lists the bytes of memory that change
+    uint8_t cycles;
+} Vector;
+
+// Instructions run from $0300 with their data in pages 0, 1, 6 and 7, so that no store touches the code;
+// indexed modes cross a page wherever they can
+const Vector vectors[] =
+{
+    { { 0x00, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0xFFFE, 0x00 }, { 0xFFFF, 0x90 } } }, { 0x9000, 0x96, 0x25, 0x37, 0x65, 0xF7, { { 0x01F8, 0x75 }, { 0x01F9, 0x02 }, { 0x01FA, 0x03 } } }, 7 }, // BRK
+    { { 0x01, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0xB7, 0x25, 0x37, 0xE5, 0xFA, {} }, 6 }, // ORA
+    { { 0x02, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0x03, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0xFE, 0x25, 0x37, 0xE5, 0xFA, { { 0x0710, 0x6A } } }, 8 }, // SLO
+    { { 0x04, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // NOP
+    { { 0x05, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0xB7, 0x25, 0x37, 0xE5, 0xFA, {} }, 3 }, // ORA
+    { { 0x06, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0x6A } } }, 5 }, // ASL
+    { { 0x07, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0xFE, 0x25, 0x37, 0xE5, 0xFA, { { 0x0040, 0x6A } } }, 5 }, // SLO
+    { { 0x08, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xF9, { { 0x01FA, 0x75 } } }, 3 }, // PHP
+    { { 0x09, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0xB7, 0x25, 0x37, 0xE5, 0xFA, {} }, 2 }, // ORA
+    { { 0x0A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x2C, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // ASL
+    { { 0x0B, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 2 }, // ANC
+    { { 0x0C, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // NOP
+    { { 0x0D, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0xB7, 0x25, 0x37, 0xE5, 0xFA, {} }, 4 }, // ORA
+    { { 0x0E, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0x6A } } }, 6 }, // ASL
+    { { 0x0F, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0xFE, 0x25, 0x37, 0xE5, 0xFA, { { 0x0650, 0x6A } } }, 6 }, // SLO
+    { { 0x10, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0312, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // BPL
+    { { 0x10, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, 2 }, // BPL, inverted flags
+    { { 0x10, 0x20, 0x00 }, { 0x03F0, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0412, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // BPL across a page
+    { { 0x11, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0xB7, 0x25, 0x37, 0xE5, 0xFA, {} }, 6 }, // ORA
+    { { 0x12, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0x13, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0xFE, 0x25, 0x37, 0xE5, 0xFA, { { 0x0727, 0x6A } } }, 8 }, // SLO
+    { { 0x14, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // NOP
+    { { 0x15, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0xB7, 0x25, 0x37, 0xE5, 0xFA, {} }, 4 }, // ORA
+    { { 0x16, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x6A } } }, 6 }, // ASL
+    { { 0x17, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0xFE, 0x25, 0x37, 0xE5, 0xFA, { { 0x0065, 0x6A } } }, 6 }, // SLO
+    { { 0x18, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x64, 0xFA, {} }, 2 }, // CLC
+    { { 0x19, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0xB7, 0x25, 0x37, 0xE5, 0xFA, {} }, 5 }, // ORA
+    { { 0x1A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0x1B, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0xFE, 0x25, 0x37, 0xE5, 0xFA, { { 0x0727, 0x6A } } }, 7 }, // SLO
+    { { 0x1C, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // NOP
+    { { 0x1D, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0xB7, 0x25, 0x37, 0xE5, 0xFA, {} }, 5 }, // ORA
+    { { 0x1E, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0x6A } } }, 7 }, // ASL
+    { { 0x1F, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0xFE, 0x25, 0x37, 0xE5, 0xFA, { { 0x0715, 0x6A } } }, 7 }, // SLO
+    { { 0x20, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0650, 0x96, 0x25, 0x37, 0x65, 0xF8, { { 0x01F9, 0x02 }, { 0x01FA, 0x03 } } }, 6 }, // JSR
+    { { 0x21, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 6 }, // AND
+    { { 0x22, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0x23, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0x02, 0x25, 0x37, 0x65, 0xFA, { { 0x0710, 0x6B } } }, 8 }, // RLA
+    { { 0x24, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xA5, 0xFA, {} }, 3 }, // BIT
+    { { 0x25, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 3 }, // AND
+    { { 0x26, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0x6B } } }, 5 }, // ROL
+    { { 0x27, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x02, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0x6B } } }, 5 }, // RLA
+    { { 0x28, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x01FB, 0xB5 } } }, { 0x0301, 0x96, 0x25, 0x37, 0xA5, 0xFB, {} }, 4 }, // PLP
+    { { 0x29, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 2 }, // AND
+    { { 0x2A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x2D, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // ROL
+    { { 0x2B, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 2 }, // ANC
+    { { 0x2C, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xA5, 0xFA, {} }, 4 }, // BIT
+    { { 0x2D, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 4 }, // AND
+    { { 0x2E, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0x6B } } }, 6 }, // ROL
+    { { 0x2F, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x02, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0x6B } } }, 6 }, // RLA
+    { { 0x30, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // BMI
+    { { 0x30, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, { 0x0312, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, 3 }, // BMI, inverted flags
+    { { 0x30, 0x20, 0x00 }, { 0x03F0, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x03F2, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // BMI across a page
+    { { 0x31, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 6 }, // AND
+    { { 0x32, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0x33, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0x02, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0x6B } } }, 8 }, // RLA
+    { { 0x34, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // NOP
+    { { 0x35, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 4 }, // AND
+    { { 0x36, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x6B } } }, 6 }, // ROL
+    { { 0x37, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x02, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x6B } } }, 6 }, // RLA
+    { { 0x38, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // SEC
+    { { 0x39, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 5 }, // AND
+    { { 0x3A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0x3B, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x02, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0x6B } } }, 7 }, // RLA
+    { { 0x3C, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // NOP
+    { { 0x3D, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x94, 0x25, 0x37, 0xE5, 0xFA, {} }, 5 }, // AND
+    { { 0x3E, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0x6B } } }, 7 }, // ROL
+    { { 0x3F, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x02, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0x6B } } }, 7 }, // RLA
+    { { 0x40, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x01FB, 0xC3 }, { 0x01FC, 0x34 }, { 0x01FD, 0x12 } } }, { 0x1234, 0x96, 0x25, 0x37, 0xE3, 0xFD, {} }, 6 }, // RTI
+    { { 0x41, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0x23, 0x25, 0x37, 0x65, 0xFA, {} }, 6 }, // EOR
+    { { 0x42, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0x43, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0xCC, 0x25, 0x37, 0xE5, 0xFA, { { 0x0710, 0x5A } } }, 8 }, // SRE
+    { { 0x44, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // NOP
+    { { 0x45, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x23, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // EOR
+    { { 0x46, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0x5A } } }, 5 }, // LSR
+    { { 0x47, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0xCC, 0x25, 0x37, 0xE5, 0xFA, { { 0x0040, 0x5A } } }, 5 }, // SRE
+    { { 0x48, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xF9, { { 0x01FA, 0x96 } } }, 3 }, // PHA
+    { { 0x49, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x23, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // EOR
+    { { 0x4A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x4B, 0x25, 0x37, 0x64, 0xFA, {} }, 2 }, // LSR
+    { { 0x4B, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x4A, 0x25, 0x37, 0x64, 0xFA, {} }, 2 }, // ALR
+    { { 0x4C, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0650, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // JMP
+    { { 0x4D, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x23, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // EOR
+    { { 0x4E, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0x5A } } }, 6 }, // LSR
+    { { 0x4F, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0xCC, 0x25, 0x37, 0xE5, 0xFA, { { 0x0650, 0x5A } } }, 6 }, // SRE
+    { { 0x50, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // BVC
+    { { 0x50, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, { 0x0312, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, 3 }, // BVC, inverted flags
+    { { 0x50, 0x20, 0x00 }, { 0x03F0, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x03F2, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // BVC across a page
+    { { 0x51, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0x23, 0x25, 0x37, 0x65, 0xFA, {} }, 6 }, // EOR
+    { { 0x52, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0x53, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0xCC, 0x25, 0x37, 0xE5, 0xFA, { { 0x0727, 0x5A } } }, 8 }, // SRE
+    { { 0x54, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // NOP
+    { { 0x55, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x23, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // EOR
+    { { 0x56, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x5A } } }, 6 }, // LSR
+    { { 0x57, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0xCC, 0x25, 0x37, 0xE5, 0xFA, { { 0x0065, 0x5A } } }, 6 }, // SRE
+    { { 0x58, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x61, 0xFA, {} }, 2 }, // CLI
+    { { 0x59, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x23, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // EOR
+    { { 0x5A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0x5B, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0xCC, 0x25, 0x37, 0xE5, 0xFA, { { 0x0727, 0x5A } } }, 7 }, // SRE
+    { { 0x5C, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // NOP
+    { { 0x5D, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x23, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // EOR
+    { { 0x5E, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0x5A } } }, 7 }, // LSR
+    { { 0x5F, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0xCC, 0x25, 0x37, 0xE5, 0xFA, { { 0x0715, 0x5A } } }, 7 }, // SRE
+    { { 0x60, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x01FB, 0x33 }, { 0x01FC, 0x12 } } }, { 0x1234, 0x96, 0x25, 0x37, 0x65, 0xFC, {} }, 6 }, // RTS
+    { { 0x61, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0x4C, 0x25, 0x37, 0x65, 0xFA, {} }, 6 }, // ADC
+    { { 0x62, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0x63, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0x71, 0x25, 0x37, 0x65, 0xFA, { { 0x0710, 0xDA } } }, 8 }, // RRA
+    { { 0x64, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // NOP
+    { { 0x65, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x4C, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // ADC
+    { { 0x66, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0040, 0xDA } } }, 5 }, // ROR
+    { { 0x67, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x71, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xDA } } }, 5 }, // RRA
+    { { 0x68, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x01FB, 0xB5 } } }, { 0x0301, 0xB5, 0x25, 0x37, 0xE5, 0xFB, {} }, 4 }, // PLA
+    { { 0x69, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x4C, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // ADC
+    { { 0x6A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0xCB, 0x25, 0x37, 0xE4, 0xFA, {} }, 2 }, // ROR
+    { { 0x6B, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0xCA, 0x25, 0x37, 0xE5, 0xFA, {} }, 2 }, // ARR
+    { { 0x6C, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0x34 }, { 0x0651, 0x12 } } }, { 0x1234, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // JMP
+    { { 0x6D, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x4C, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // ADC
+    { { 0x6E, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0650, 0xDA } } }, 6 }, // ROR
+    { { 0x6F, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x71, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xDA } } }, 6 }, // RRA
+    { { 0x70, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0312, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // BVS
+    { { 0x70, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, 2 }, // BVS, inverted flags
+    { { 0x70, 0x20, 0x00 }, { 0x03F0, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0412, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // BVS across a page
+    { { 0x71, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0x4C, 0x25, 0x37, 0x65, 0xFA, {} }, 6 }, // ADC
+    { { 0x72, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0x73, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0x71, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xDA } } }, 8 }, // RRA
+    { { 0x74, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // NOP
+    { { 0x75, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x4C, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // ADC
+    { { 0x76, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0065, 0xDA } } }, 6 }, // ROR
+    { { 0x77, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x71, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xDA } } }, 6 }, // RRA
+    { { 0x78, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // SEI
+    { { 0x79, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x4C, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // ADC
+    { { 0x7A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0x7B, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x71, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xDA } } }, 7 }, // RRA
+    { { 0x7C, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // NOP
+    { { 0x7D, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x4C, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // ADC
+    { { 0x7E, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0715, 0xDA } } }, 7 }, // ROR
+    { { 0x7F, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x71, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xDA } } }, 7 }, // RRA
+    { { 0x80, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0x81, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0710, 0x96 } } }, 6 }, // STA
+    { { 0x82, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0x83, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0710, 0x04 } } }, 6 }, // SAX
+    { { 0x84, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0x37 } } }, 3 }, // STY
+    { { 0x85, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0x96 } } }, 3 }, // STA
+    { { 0x86, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0x25 } } }, 3 }, // STX
+    { { 0x87, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0x04 } } }, 3 }, // SAX
+    { { 0x88, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x36, 0x65, 0xFA, {} }, 2 }, // DEY
+    { { 0x89, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0x8A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x25, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // TXA
+    { { 0x8B, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x25, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // XAA
+    { { 0x8C, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0x37 } } }, 4 }, // STY
+    { { 0x8D, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0x96 } } }, 4 }, // STA
+    { { 0x8E, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0x25 } } }, 4 }, // STX
+    { { 0x8F, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0x04 } } }, 4 }, // SAX
+    { { 0x90, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // BCC
+    { { 0x90, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, { 0x0312, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, 3 }, // BCC, inverted flags
+    { { 0x90, 0x20, 0x00 }, { 0x03F0, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x03F2, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // BCC across a page
+    { { 0x91, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0x96 } } }, 6 }, // STA
+    { { 0x92, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0x93, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0x00 } } }, 6 }, // AHX
+    { { 0x94, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x37 } } }, 4 }, // STY
+    { { 0x95, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x96 } } }, 4 }, // STA
+    { { 0x96, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0077, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0077, 0x25 } } }, 4 }, // STX
+    { { 0x97, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0077, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0077, 0x04 } } }, 4 }, // SAX
+    { { 0x98, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x37, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // TYA
+    { { 0x99, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0x96 } } }, 5 }, // STA
+    { { 0x9A, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0x25, {} }, 2 }, // TXS
+    { { 0x9B, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0x04, { { 0x0727, 0x04 } } }, 5 }, // TAS
+    { { 0x9C, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0x07 } } }, 5 }, // SHY
+    { { 0x9D, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0x96 } } }, 5 }, // STA
+    { { 0x9E, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0x05 } } }, 5 }, // SHX
+    { { 0x9F, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0x04 } } }, 5 }, // AHX
+    { { 0xA0, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0xB5, 0xE5, 0xFA, {} }, 2 }, // LDY
+    { { 0xA1, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0xB5, 0x25, 0x37, 0xE5, 0xFA, {} }, 6 }, // LDA
+    { { 0xA2, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0xB5, 0x37, 0xE5, 0xFA, {} }, 2 }, // LDX
+    { { 0xA3, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0xB5, 0xB5, 0x37, 0xE5, 0xFA, {} }, 6 }, // LAX
+    { { 0xA4, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0xB5, 0xE5, 0xFA, {} }, 3 }, // LDY
+    { { 0xA5, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0xB5, 0x25, 0x37, 0xE5, 0xFA, {} }, 3 }, // LDA
+    { { 0xA6, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0xB5, 0x37, 0xE5, 0xFA, {} }, 3 }, // LDX
+    { { 0xA7, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0xB5, 0xB5, 0x37, 0xE5, 0xFA, {} }, 3 }, // LAX
+    { { 0xA8, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x96, 0xE5, 0xFA, {} }, 2 }, // TAY
+    { { 0xA9, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0xB5, 0x25, 0x37, 0xE5, 0xFA, {} }, 2 }, // LDA
+    { { 0xAA, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x96, 0x37, 0xE5, 0xFA, {} }, 2 }, // TAX
+    { { 0xAB, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0xB5, 0xB5, 0x37, 0xE5, 0xFA, {} }, 2 }, // LAX
+    { { 0xAC, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0xB5, 0xE5, 0xFA, {} }, 4 }, // LDY
+    { { 0xAD, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0xB5, 0x25, 0x37, 0xE5, 0xFA, {} }, 4 }, // LDA
+    { { 0xAE, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0xB5, 0x37, 0xE5, 0xFA, {} }, 4 }, // LDX
+    { { 0xAF, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0xB5, 0xB5, 0x37, 0xE5, 0xFA, {} }, 4 }, // LAX
+    { { 0xB0, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0312, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // BCS
+    { { 0xB0, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, 2 }, // BCS, inverted flags
+    { { 0xB0, 0x20, 0x00 }, { 0x03F0, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0412, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // BCS across a page
+    { { 0xB1, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0xB5, 0x25, 0x37, 0xE5, 0xFA, {} }, 6 }, // LDA
+    { { 0xB2, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0xB3, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0xB5, 0xB5, 0x37, 0xE5, 0xFA, {} }, 6 }, // LAX
+    { { 0xB4, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0xB5, 0xE5, 0xFA, {} }, 4 }, // LDY
+    { { 0xB5, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0xB5, 0x25, 0x37, 0xE5, 0xFA, {} }, 4 }, // LDA
+    { { 0xB6, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0077, 0xB5 } } }, { 0x0302, 0x96, 0xB5, 0x37, 0xE5, 0xFA, {} }, 4 }, // LDX
+    { { 0xB7, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0077, 0xB5 } } }, { 0x0302, 0xB5, 0xB5, 0x37, 0xE5, 0xFA, {} }, 4 }, // LAX
+    { { 0xB8, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x25, 0xFA, {} }, 2 }, // CLV
+    { { 0xB9, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0xB5, 0x25, 0x37, 0xE5, 0xFA, {} }, 5 }, // LDA
+    { { 0xBA, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0xFA, 0x37, 0xE5, 0xFA, {} }, 2 }, // TSX
+    { { 0xBB, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0xB0, 0xB0, 0x37, 0xE5, 0xB0, {} }, 5 }, // LAS
+    { { 0xBC, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0xB5, 0xE5, 0xFA, {} }, 5 }, // LDY
+    { { 0xBD, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0xB5, 0x25, 0x37, 0xE5, 0xFA, {} }, 5 }, // LDA
+    { { 0xBE, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x96, 0xB5, 0x37, 0xE5, 0xFA, {} }, 5 }, // LDX
+    { { 0xBF, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0xB5, 0xB5, 0x37, 0xE5, 0xFA, {} }, 5 }, // LAX
+    { { 0xC0, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 2 }, // CPY
+    { { 0xC1, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 6 }, // CMP
+    { { 0xC2, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0xC3, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, { { 0x0710, 0xB4 } } }, 8 }, // DCP
+    { { 0xC4, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 3 }, // CPY
+    { { 0xC5, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 3 }, // CMP
+    { { 0xC6, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0040, 0xB4 } } }, 5 }, // DEC
+    { { 0xC7, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, { { 0x0040, 0xB4 } } }, 5 }, // DCP
+    { { 0xC8, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x38, 0x65, 0xFA, {} }, 2 }, // INY
+    { { 0xC9, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 2 }, // CMP
+    { { 0xCA, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x24, 0x37, 0x65, 0xFA, {} }, 2 }, // DEX
+    { { 0xCB, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x4F, 0x37, 0x64, 0xFA, {} }, 2 }, // AXS
+    { { 0xCC, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 4 }, // CPY
+    { { 0xCD, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 4 }, // CMP
+    { { 0xCE, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0650, 0xB4 } } }, 6 }, // DEC
+    { { 0xCF, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE4, 0xFA, { { 0x0650, 0xB4 } } }, 6 }, // DCP
+    { { 0xD0, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0312, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 3 }, // BNE
+    { { 0xD0, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, 2 }, // BNE, inverted flags
+    { { 0xD0, 0x20, 0x00 }, { 0x03F0, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0412, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // BNE across a page
+    { { 0xD1, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 6 }, // CMP
+    { { 0xD2, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0xD3, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, { { 0x0727, 0xB4 } } }, 8 }, // DCP
+    { { 0xD4, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // NOP
+    { { 0xD5, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 4 }, // CMP
+    { { 0xD6, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0065, 0xB4 } } }, 6 }, // DEC
+    { { 0xD7, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE4, 0xFA, { { 0x0065, 0xB4 } } }, 6 }, // DCP
+    { { 0xD8, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // CLD
+    { { 0xD9, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 5 }, // CMP
+    { { 0xDA, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0xDB, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE4, 0xFA, { { 0x0727, 0xB4 } } }, 7 }, // DCP
+    { { 0xDC, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // NOP
+    { { 0xDD, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE4, 0xFA, {} }, 5 }, // CMP
+    { { 0xDE, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0715, 0xB4 } } }, 7 }, // DEC
+    { { 0xDF, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE4, 0xFA, { { 0x0715, 0xB4 } } }, 7 }, // DCP
+    { { 0xE0, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x64, 0xFA, {} }, 2 }, // CPX
+    { { 0xE1, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0xE1, 0x25, 0x37, 0xA4, 0xFA, {} }, 6 }, // SBC
+    { { 0xE2, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0xE3, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0x10 }, { 0x0066, 0x07 }, { 0x0710, 0xB5 } } }, { 0x0302, 0xE0, 0x25, 0x37, 0xA4, 0xFA, { { 0x0710, 0xB6 } } }, 8 }, // ISC
+    { { 0xE4, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x64, 0xFA, {} }, 3 }, // CPX
+    { { 0xE5, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0xE1, 0x25, 0x37, 0xA4, 0xFA, {} }, 3 }, // SBC
+    { { 0xE6, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0040, 0xB6 } } }, 5 }, // INC
+    { { 0xE7, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xB5 } } }, { 0x0302, 0xE0, 0x25, 0x37, 0xA4, 0xFA, { { 0x0040, 0xB6 } } }, 5 }, // ISC
+    { { 0xE8, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x26, 0x37, 0x65, 0xFA, {} }, 2 }, // INX
+    { { 0xE9, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0xE1, 0x25, 0x37, 0xA4, 0xFA, {} }, 2 }, // SBC
+    { { 0xEA, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0xEB, 0xB5, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0xE1, 0x25, 0x37, 0xA4, 0xFA, {} }, 2 }, // SBC
+    { { 0xEC, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x64, 0xFA, {} }, 4 }, // CPX
+    { { 0xED, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0xE1, 0x25, 0x37, 0xA4, 0xFA, {} }, 4 }, // SBC
+    { { 0xEE, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0650, 0xB6 } } }, 6 }, // INC
+    { { 0xEF, 0x50, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0650, 0xB5 } } }, { 0x0303, 0xE0, 0x25, 0x37, 0xA4, 0xFA, { { 0x0650, 0xB6 } } }, 6 }, // ISC
+    { { 0xF0, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // BEQ
+    { { 0xF0, 0x10, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, { 0x0312, 0x96, 0x25, 0x37, 0xA6, 0xFA, {} }, 3 }, // BEQ, inverted flags
+    { { 0xF0, 0x20, 0x00 }, { 0x03F0, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x03F2, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // BEQ across a page
+    { { 0xF1, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0xE1, 0x25, 0x37, 0xA4, 0xFA, {} }, 6 }, // SBC
+    { { 0xF2, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 0 }, // STP
+    { { 0xF3, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0040, 0xF0 }, { 0x0041, 0x06 }, { 0x0727, 0xB5 } } }, { 0x0302, 0xE0, 0x25, 0x37, 0xA4, 0xFA, { { 0x0727, 0xB6 } } }, 8 }, // ISC
+    { { 0xF4, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 4 }, // NOP
+    { { 0xF5, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0xE1, 0x25, 0x37, 0xA4, 0xFA, {} }, 4 }, // SBC
+    { { 0xF6, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0065, 0xB6 } } }, 6 }, // INC
+    { { 0xF7, 0x40, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0065, 0xB5 } } }, { 0x0302, 0xE0, 0x25, 0x37, 0xA4, 0xFA, { { 0x0065, 0xB6 } } }, 6 }, // ISC
+    { { 0xF8, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x6D, 0xFA, {} }, 2 }, // SED
+    { { 0xF9, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0xE1, 0x25, 0x37, 0xA4, 0xFA, {} }, 5 }, // SBC
+    { { 0xFA, 0x00, 0x00 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, { 0x0301, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // NOP
+    { { 0xFB, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0727, 0xB5 } } }, { 0x0303, 0xE0, 0x25, 0x37, 0xA4, 0xFA, { { 0x0727, 0xB6 } } }, 7 }, // ISC
+    { { 0xFC, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0x65, 0xFA, {} }, 5 }, // NOP
+    { { 0xFD, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0xE1, 0x25, 0x37, 0xA4, 0xFA, {} }, 5 }, // SBC
+    { { 0xFE, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0x96, 0x25, 0x37, 0xE5, 0xFA, { { 0x0715, 0xB6 } } }, 7 }, // INC
+    { { 0xFF, 0xF0, 0x06 }, { 0x0300, 0x96, 0x25, 0x37, 0x65, 0xFA, { { 0x0715, 0xB5 } } }, { 0x0303, 0xE0, 0x25, 0x37, 0xA4, 0xFA, { { 0x0715, 0xB6 } } }, 7 }, // ISC
+    { { 0x69, 0x7F, 0x00 }, { 0x0300, 0x01, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0x80, 0x25, 0x37, 0xE4, 0xFA, {} }, 2 }, // ADC into signed overflow
+    { { 0x69, 0x00, 0x00 }, { 0x0300, 0xFF, 0x25, 0x37, 0x25, 0xFA, {} }, { 0x0302, 0x00, 0x25, 0x37, 0x27, 0xFA, {} }, 2 }, // ADC with carry out to zero
+    { { 0x69, 0x80, 0x00 }, { 0x0300, 0x80, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0x00, 0x25, 0x37, 0x67, 0xFA, {} }, 2 }, // ADC with carry and overflow
+    { { 0x69, 0x28, 0x00 }, { 0x0300, 0x19, 0x25, 0x37, 0x2D, 0xFA, {} }, { 0x0302, 0x42, 0x25, 0x37, 0x2C, 0xFA, {} }, 2 }, // ADC ignoring decimal mode
+    { { 0xE9, 0x01, 0x00 }, { 0x0300, 0x00, 0x25, 0x37, 0x25, 0xFA, {} }, { 0x0302, 0xFF, 0x25, 0x37, 0xA4, 0xFA, {} }, 2 }, // SBC with borrow out
+    { { 0xE9, 0x01, 0x00 }, { 0x0300, 0x80, 0x25, 0x37, 0x25, 0xFA, {} }, { 0x0302, 0x7F, 0x25, 0x37, 0x65, 0xFA, {} }, 2 }, // SBC into signed overflow
+    { { 0xE9, 0x50, 0x00 }, { 0x0300, 0x50, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0xFF, 0x25, 0x37, 0xA4, 0xFA, {} }, 2 }, // SBC with borrow in
+    { { 0xE9, 0xFF, 0x00 }, { 0x0300, 0x7F, 0x25, 0x37, 0x25, 0xFA, {} }, { 0x0302, 0x80, 0x25, 0x37, 0xE4, 0xFA, {} }, 2 }, // SBC of a negative into overflow
+    { { 0xC9, 0x40, 0x00 }, { 0x0300, 0x40, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0x40, 0x25, 0x37, 0x27, 0xFA, {} }, 2 }, // CMP equal
+    { { 0xC9, 0x41, 0x00 }, { 0x0300, 0x40, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0x40, 0x25, 0x37, 0xA4, 0xFA, {} }, 2 }, // CMP less
+    { { 0xE0, 0x25, 0x00 }, { 0x0300, 0x20, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0x20, 0x25, 0x37, 0x27, 0xFA, {} }, 2 }, // CPX equal
+    { { 0xC0, 0x38, 0x00 }, { 0x0300, 0x30, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0x30, 0x25, 0x37, 0xA4, 0xFA, {} }, 2 }, // CPY less
+    { { 0x6B, 0xFF, 0x00 }, { 0x0300, 0xFF, 0x25, 0x37, 0x25, 0xFA, {} }, { 0x0302, 0xFF, 0x25, 0x37, 0xA5, 0xFA, {} }, 2 }, // ARR with carry in
+    { { 0x6B, 0xFF, 0x00 }, { 0x0300, 0xC0, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0x60, 0x25, 0x37, 0x25, 0xFA, {} }, 2 }, // ARR setting carry
+    { { 0xCB, 0x21, 0x00 }, { 0x0300, 0x20, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0x20, 0xFF, 0x37, 0xA4, 0xFA, {} }, 2 }, // AXS with borrow
+    { { 0x0B, 0xFF, 0x00 }, { 0x0300, 0x80, 0x25, 0x37, 0x24, 0xFA, {} }, { 0x0302, 0x80, 0x25, 0x37, 0xA5, 0xFA, {} }, 2 }, // ANC of a negative
+};
+
+const char *modeNames[] = { "IMP", "ACC", "IMM", "ZPG", "ZPX", "ZPY", "ABS", "ABX", "ABY", "IND", "IZX", "IZY", "REL" };
+
+uint8_t initial[0x10000], expected[0x10000];
+
+void load(const Vector *vector)
+{
+    // Set up the memory and registers of a vector's initial state
+    for (int i = 0; i < 4; i++)
+    {
+        if (vector->initial.memory[i].address)
+            memory[vector->initial.memory[i].address] = vector->initial.memory[i].value;
+    }
+    programCounter = vector->initial.programCounter;
+    accumulator = vector->initial.accumulator;
+    registerX = vector->initial.registerX;
+    registerY = vector->initial.registerY;
+    setFlags(vector->initial.flags);
+    stackPointer = vector->initial.stackPointer;
+}
+
+void step()
+{
+    // Run one instruction, which the CPU starts on the first cycle after the last one's have finished
+    targetCycles = 0;
+    core::globalCycles = 0;
+    runCycle();
+}
+
+bool check(const Vector *vector, const char *path)
+{
+    // Start from a clean CPU with empty memory, writing the code through the bus so that stale decodes are dropped
+    reset();
+    interrupts = 0;
+    memset(memory, 0, sizeof(memory));
+    for (int i = 0; i < 3; i++)
+        memoryWrite(vector->initial.programCounter + i, vector->code[i]);
+    load(vector);
+
+    // Work out what all of memory should hold afterwards
+    memcpy(initial, memory, sizeof(initial));
+    memcpy(expected, memory, sizeof(expected));
+    for (int i = 0; i < 4; i++)
+    {
+        if (vector->final.memory[i].address)
+            expected[vector->final.memory[i].address] = vector->final.memory[i].value;
+    }
+
+    // Run the instruction twice with the decode cache, so that both decoding and the cached entry are checked
+    bool passed = true;
+    for (int run = 0; run < (config::decodeCache ? 2 : 1); run++)
+    {
+        if (run > 0)
+        {
+            memcpy(memory, initial, sizeof(memory));
+            load(vector);
+        }
+        step();
+
+        // Compare the final state, reporting every difference
+        const State *final = &vector->final;
+        const uint8_t actual[] = { accumulator, registerX, registerY, getFlags(), stackPointer, (uint8_t)targetCycles };
+        const uint8_t wanted[] = { final->accumulator, final->registerX, final->registerY, final->flags,
+            final->stackPointer, vector->cycles };
+        const char *names[] = { "A", "X", "Y", "P", "S", "cycles" };
+
+        char prefix[64];
+        snprintf(prefix, sizeof(prefix), "%02X %s %s (%s, vector %d)", vector->code[0], opcodes[vector->code[0]].mnemonic,
+            modeNames[opcodes[vector->code[0]].mode], path, (int)(vector - vectors));
+
+        if (programCounter != final->programCounter)
+        {
+            printf("%s: PC is $%04X, expected $%04X\n", prefix, programCounter, final->programCounter);
+            passed = false;
+        }
+        for (int i = 0; i < 6; i++)
+        {
+            if (actual[i] != wanted[i])
+            {
+                printf("%s: %s is $%02X, expected $%02X\n", prefix, names[i], actual[i], wanted[i]);
+                passed = false;
+            }
+        }
+        for (uint32_t address = 0; address < 0x10000; address++)
+        {
+            if (memory[address] != expected[address])
+            {
+                printf("%s: $%04X is $%02X, expected $%02X\n", prefix, address, memory[address], expected[address]);
+                passed = false;
+            }
+        }
+    }
+
+    return passed;
+}
+
+double measure(const Vector *vector, uint32_t iterations, bool driverOnly)
+{
+    // Set the vector up once, then restore its initial state before every run
+    reset();
+    interrupts = 0;
+    memset(memory, 0, sizeof(memory));
+    for (int i = 0; i < 3; i++)
+        memoryWrite(vector->initial.programCounter + i, vector->code[i]);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        load(vector);
+        if (!driverOnly)
+            step();
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    return chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)iterations;
+}
+
+}
+
+using namespace cputest;
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = (argc > 1) ? strtoul(argv[1], nullptr, 0) : 200000;
+    if (iterations == 0)
+    {
+        printf("Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    // Keep everything that could run more than the one instruction out of the way
+    config::jit = 0;
+    config::recompiled = 0;
+    config::idleSkip = 0;
+    config::trace = 0;
+    config::profile = 0;
+    config::codeLog = 0;
+
+    // Check every vector through the interpreter and through the decode cache
+    const size_t count = sizeof(vectors) / sizeof(vectors[0]);
+    uint32_t failures = 0;
+    for (int cache = 0; cache < 2; cache++)
+    {
+        config::decodeCache = cache;
+        for (size_t i = 0; i < count; i++)
+            failures += !check(&vectors[i], cache ? "decode cache" : "interpreter");
+    }
+    printf("Checked %u vectors through the interpreter and the decode cache: %u failed\n\n", (unsigned int)count, failures);
+
+    // Time the first vector of each opcode through both paths, net of the cost of restoring its state
+    double overhead = measure(&vectors[0], iterations, true);
+    printf("Opcode  Mnemonic  Mode  Interpreter  Decode cache  (ns per instruction, less %.1f ns of setup)\n", overhead);
+    bool timed[0x100] = {};
+    double totals[2] = {};
+    for (size_t i = 0; i < count; i++)
+    {
+        uint8_t opcode = vectors[i].code[0];
+        if (timed[opcode])
+            continue;
+        timed[opcode] = true;
+
+        double times[2];
+        for (int cache = 0; cache < 2; cache++)
+        {
+            config::decodeCache = cache;
+            times[cache] = measure(&vectors[i], iterations, false) - overhead;
+            totals[cache] += times[cache];
+        }
+        printf("  %02X    %s       %s   %9.1f  %12.1f\n", opcode, opcodes[opcode].mnemonic,
+            modeNames[opcodes[opcode].mode], times[0], times[1]);
+    }
+    printf("Average               %9.1f  %12.1f\n", totals[0] / 0x100, totals[1] / 0x100);
+
+    return failures ? 1 : 0;
+}
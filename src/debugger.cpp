@@ -0,0 +1,210 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <cstring>
+
+#include "core.h"
+#include "debugger.h"
+#include "cpu.h"
+
+namespace debugger
+{
+
+// Bitmaps with a bit for every CPU address, so that checking one costs a single bit test
+uint8_t breakpoints[0x2000];
+uint8_t everything[0x2000];
+uint8_t readWatches[0x2000];
+uint8_t writeWatches[0x2000];
+
+const uint8_t *breakMap = breakpoints;
+uint32_t breakpointCount, watchpointCount;
+
+bool active;
+bool stopped;
+Stop stop;
+
+// When resuming, the instruction that execution stopped at runs once without stopping again
+bool skipping;
+uint16_t skipAddress;
+
+void update()
+{
+    // Force the interpreter while anything could stop execution, so that no instruction is hidden in compiled code
+    active = breakpointCount || watchpointCount || breakMap == everything;
+}
+
+void reset()
+{
+    // Clear all breakpoints and watchpoints, and start running
+    memset(everything, 0xFF, sizeof(everything));
+    clear();
+    stopped = skipping = false;
+    stop.reason = STOP_NONE;
+}
+
+bool check()
+{
+    // Let the instruction that execution stopped at run when resuming
+    if (skipping && cpu::programCounter == skipAddress)
+    {
+        skipping = false;
+        return false;
+    }
+
+    // Stop at the instruction boundary, keeping the reason given by a watchpoint or step
+    if (stop.reason == STOP_NONE)
+        stop.reason = STOP_BREAKPOINT;
+    stop.programCounter = cpu::programCounter;
+    breakMap = breakpoints;
+    stopped = true;
+    update();
+    return true;
+}
+
+void watchHit(uint8_t reason, uint16_t address, uint8_t value)
+{
+    // Ignore accesses made through the debugger while stopped
+    if (stopped)
+        return;
+
+    // Stop at the next instruction boundary, once the accessing instruction has finished
+    stop.reason = reason;
+    stop.address = address;
+    stop.value = value;
+    breakMap = everything;
+    update();
+}
+
+void setBreakpoint(uint16_t address, bool enabled)
+{
+    // Set or clear the address's bit in the breakpoint bitmap
+    uint8_t *byte = &breakpoints[address >> 3];
+    uint8_t bit = 1 << (address & 7);
+    if (enabled != (bool)(*byte & bit))
+    {
+        *byte ^= bit;
+        breakpointCount += enabled ? 1 : -1;
+    }
+    update();
+}
+
+void setWatchpoint(uint16_t address, uint8_t watch, bool enabled)
+{
+    // Set or clear the address's bits in the watchpoint bitmaps
+    uint8_t *bitmaps[] = { readWatches, writeWatches };
+    uint8_t bit = 1 << (address & 7);
+    for (int i = 0; i < 2; i++)
+    {
+        uint8_t *byte = &bitmaps[i][address >> 3];
+        if ((watch & (1 << i)) && enabled != (bool)(*byte & bit))
+        {
+            *byte ^= bit;
+            watchpointCount += enabled ? 1 : -1;
+        }
+    }
+
+    // Flag the page for the bus to check the bitmaps, only while it has watchpoints
+    bool watched = false;
+    uint16_t first = (address >> 3) & ~0x1F;
+    for (int i = 0; i < 0x20; i++)
+        watched |= readWatches[first + i] | writeWatches[first + i];
+    cpu::pages[address >> 8].watched = watched;
+    update();
+}
+
+void clear()
+{
+    // Remove every breakpoint and watchpoint
+    memset(breakpoints, 0, sizeof(breakpoints));
+    memset(readWatches, 0, sizeof(readWatches));
+    memset(writeWatches, 0, sizeof(writeWatches));
+    for (int i = 0; i < 0x100; i++)
+        cpu::pages[i].watched = false;
+    breakpointCount = watchpointCount = 0;
+    breakMap = breakpoints;
+    update();
+}
+
+void resume()
+{
+    // Continue from the stop, running the instruction at it first
+    skipping = true;
+    skipAddress = cpu::programCounter;
+    stop.reason = STOP_NONE;
+    stopped = false;
+}
+
+void step()
+{
+    // Run the instruction at the stop, then stop again at the next boundary
+    resume();
+    stop.reason = STOP_STEP;
+    breakMap = everything;
+    update();
+}
+
+void pause()
+{
+    // Stop at the next instruction boundary
+    if (!stopped)
+    {
+        stop.reason = STOP_STEP;
+        breakMap = everything;
+        update();
+    }
+}
+
+Registers getRegisters()
+{
+    // Gather the CPU registers, with the status flags folded together
+    Registers registers;
+    registers.programCounter = cpu::programCounter;
+    registers.accumulator = cpu::accumulator;
+    registers.registerX = cpu::registerX;
+    registers.registerY = cpu::registerY;
+    registers.flags = cpu::getFlags();
+    registers.stackPointer = cpu::stackPointer;
+    return registers;
+}
+
+void setRegisters(Registers registers)
+{
+    // Change the CPU registers while stopped
+    cpu::programCounter = registers.programCounter;
+    cpu::accumulator = registers.accumulator;
+    cpu::registerX = registers.registerX;
+    cpu::registerY = registers.registerY;
+    cpu::setFlags(registers.flags);
+    cpu::stackPointer = registers.stackPointer;
+}
+
+uint8_t peek(uint16_t address)
+{
+    // Read memory without side effects
+    return cpu::memoryPeek(address);
+}
+
+void poke(uint16_t address, uint8_t value)
+{
+    // Write memory through the bus, so that mapper registers and code invalidation behave as normal
+    cpu::memoryWrite(address, value);
+}
+
+}
@@ -0,0 +1,109 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <cstdint>
+
+namespace debugger
+{
+
+enum Reason
+{
+    STOP_NONE = 0,
+    STOP_BREAKPOINT,
+    STOP_READ,
+    STOP_WRITE,
+    STOP_STEP
+};
+
+enum Watch
+{
+    WATCH_READ  = 0x01,
+    WATCH_WRITE = 0x02
+};
+
+typedef struct
+{
+    uint8_t reason;
+    uint16_t programCounter; // Where execution stopped
+    uint16_t address; // The watched address and value of the access that caused the stop
+    uint8_t value;
+} Stop;
+
+typedef struct
+{
+    uint16_t programCounter;
+    uint8_t accumulator, registerX, registerY;
+    uint8_t flags;
+    uint8_t stackPointer;
+} Registers;
+
+// The breakpoint bitmap, or a full one when the next instruction boundary should stop regardless
+extern const uint8_t *breakMap;
+
+extern uint8_t readWatches[0x2000];
+extern uint8_t writeWatches[0x2000];
+
+extern bool active;
+extern bool stopped;
+extern Stop stop;
+
+inline bool breakpointAt(uint16_t address)
+{
+    // Test an address in the current breakpoint map
+    return breakMap[address >> 3] & (1 << (address & 7));
+}
+
+void watchHit(uint8_t reason, uint16_t address, uint8_t value);
+
+inline void watchRead(uint16_t address, uint8_t value)
+{
+    // Report a read from a page with watchpoints if it's of a watched address
+    if (readWatches[address >> 3] & (1 << (address & 7)))
+        watchHit(STOP_READ, address, value);
+}
+
+inline void watchWrite(uint16_t address, uint8_t value)
+{
+    // Report a write to a page with watchpoints if it's of a watched address
+    if (writeWatches[address >> 3] & (1 << (address & 7)))
+        watchHit(STOP_WRITE, address, value);
+}
+
+void reset();
+bool check();
+
+void setBreakpoint(uint16_t address, bool enabled);
+void setWatchpoint(uint16_t address, uint8_t watch, bool enabled);
+void clear();
+
+void resume();
+void step();
+void pause();
+
+Registers getRegisters();
+void setRegisters(Registers registers);
+uint8_t peek(uint16_t address);
+void poke(uint16_t address, uint8_t value);
+
+}
+
+#endif // DEBUGGER_H
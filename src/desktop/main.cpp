@@ -17,41 +17,201 @@
     along with NoiES. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 #include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES
 #include "GL/glut.h"
+#include "GL/glx.h"
 #include "portaudio.h"
 
 #include "../core.h"
 #include "../ppu.h"
 #include "../apu.h"
 #include "../config.h"
+#include "../cpu.h"
+#include "../debugger.h"
 #include "../mutex.h"
+#include "../pacer.h"
+#include "../timing.h"
+
+bool requestSave, requestLoad, requestTrace, requestEvents, requestTiming;
+bool requestBreak, requestContinue, requestStep;
+
+std::mutex frameMutex;
+std::condition_variable frameSignal;
+bool frameReady;
 
-bool requestSave, requestLoad;
+GLuint texture, pixelBuffer;
+bool indexedUpload;
 
 uint32_t screenFiltering = 0;
 uint32_t cropOverscan = 0;
+uint32_t vsync = 0;
+uint32_t shaderPalette = 0;
+uint32_t timingHud = 0;
+uint32_t threadAffinity[] = { 0, 0, 0 };
+uint32_t threadPriority[] = { 0, 0, 0 };
 string keyMap[] = { "l", "k", "g", "h", "w", "s", "a", "d" };
+string breakpoints, watchpoints;
 
 const vector<config::Setting> platformSettings =
 {
-    { "screenFiltering", &screenFiltering, false },
-    { "cropOverscan",    &cropOverscan,    false },
-    { "keyA",            &keyMap[0],       true  },
-    { "keyB",            &keyMap[1],       true  },
-    { "keySelect",       &keyMap[2],       true  },
-    { "keyStart",        &keyMap[3],       true  },
-    { "keyUp",           &keyMap[4],       true  },
-    { "keyDown",         &keyMap[5],       true  },
-    { "keyLeft",         &keyMap[6],       true  },
-    { "keyRight",        &keyMap[7],       true  }
+    { "screenFiltering", &screenFiltering,   false },
+    { "cropOverscan",    &cropOverscan,      false },
+    { "vsync",           &vsync,             false },
+    { "shaderPalette",   &shaderPalette,     false },
+    { "timingHud",       &timingHud,         false },
+    { "coreAffinity",    &threadAffinity[0], false },
+    { "audioAffinity",   &threadAffinity[1], false },
+    { "presentAffinity", &threadAffinity[2], false },
+    { "corePriority",    &threadPriority[0], false },
+    { "audioPriority",   &threadPriority[1], false },
+    { "presentPriority", &threadPriority[2], false },
+    { "keyA",            &keyMap[0],         true  },
+    { "keyB",            &keyMap[1],         true  },
+    { "keySelect",       &keyMap[2],         true  },
+    { "keyStart",        &keyMap[3],         true  },
+    { "keyUp",           &keyMap[4],         true  },
+    { "keyDown",         &keyMap[5],         true  },
+    { "keyLeft",         &keyMap[6],         true  },
+    { "keyRight",        &keyMap[7],         true  },
+    { "breakpoints",     &breakpoints,       true  },
+    { "watchpoints",     &watchpoints,       true  }
 };
 
+void setThreadPlacement(int thread)
+{
+#ifdef __linux__
+    const char *names[] = { "core", "audio", "present" };
+    const int fifoLevels[] = { 2, 3, 1 };
+
+    // Pin the calling thread to the CPUs set in its affinity mask
+    if (threadAffinity[thread])
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int i = 0; i < 32; i++)
+        {
+            if (threadAffinity[thread] & (1u << i))
+                CPU_SET(i, &set);
+        }
+
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error)
+            printf("Failed to set the %s thread's CPU affinity: %s\n", names[thread], strerror(error));
+    }
+
+    if (threadPriority[thread] == 1) // Lower niceness
+    {
+        if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), -10) != 0)
+            printf("Failed to lower the %s thread's niceness: %s\n", names[thread], strerror(errno));
+    }
+    else if (threadPriority[thread] == 2) // Real-time FIFO scheduling
+    {
+        // Rank audio above the core, and the core above presentation
+        sched_param param;
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO) + fifoLevels[thread];
+        int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (error)
+            printf("Failed to set FIFO scheduling for the %s thread: %s\n", names[thread], strerror(error));
+    }
+#endif
+}
+
+void setDebugPoints()
+{
+    // Set breakpoints from a list of hex addresses, like "C000,C123"
+    const char *list = breakpoints.c_str();
+    while (*list)
+    {
+        char *end;
+        uint16_t address = strtol(list, &end, 16);
+        if (end != list)
+            debugger::setBreakpoint(address, true);
+        list = *end ? end + 1 : end;
+    }
+
+    // Set watchpoints from a list of hex addresses with r, w or both after them, like "0300w,00FFrw"
+    list = watchpoints.c_str();
+    while (*list)
+    {
+        char *end;
+        uint16_t address = strtol(list, &end, 16);
+        uint8_t watch = 0;
+        for (; *end && *end != ','; end++)
+            watch |= (*end == 'r') ? debugger::WATCH_READ : (*end == 'w') ? debugger::WATCH_WRITE : 0;
+        if (watch)
+            debugger::setWatchpoint(address, watch, true);
+        list = *end ? end + 1 : end;
+    }
+}
+
+void reportStop()
+{
+    // Describe why the debugger stopped, followed by the registers and the next instruction
+    const char *reasons[] = { "", "Breakpoint", "Read watchpoint", "Write watchpoint", "Step" };
+    debugger::Registers registers = debugger::getRegisters();
+    if (debugger::stop.reason == debugger::STOP_READ || debugger::stop.reason == debugger::STOP_WRITE)
+        printf("%s hit: %04X = %02X\n", reasons[debugger::stop.reason], debugger::stop.address, debugger::stop.value);
+    else
+        printf("%s\n", reasons[debugger::stop.reason]);
+    printf("A:%02X X:%02X Y:%02X P:%02X SP:%02X  %04X  %s\n", registers.accumulator, registers.registerX,
+        registers.registerY, registers.flags, registers.stackPointer, registers.programCounter,
+        cpu::disassemble(registers.programCounter).c_str());
+}
+
 void runCore()
 {
+    setThreadPlacement(0);
+    pacer::reset();
+
     while (true)
     {
-        core::runCycle();
+        core::runFrame();
+
+        // Wait for the menu to continue or step while the debugger is stopped
+        if (debugger::stopped)
+        {
+            reportStop();
+            while (!requestContinue && !requestStep)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            requestStep ? debugger::step() : debugger::resume();
+            requestContinue = requestStep = false;
+            continue;
+        }
+        else if (requestBreak)
+        {
+            debugger::pause();
+            requestBreak = false;
+        }
+
+        // Wake the GL thread to present the new frame
+        {
+            std::lock_guard<std::mutex> guard(frameMutex);
+            frameReady = true;
+        }
+        frameSignal.notify_one();
+
+        // Pace emulation by the audio clock or the frame deadline, depending on settings, timing the wait
+        uint64_t start = timing::now();
+        if (config::audioSync)
+            pacer::syncAudio();
+        else if (config::frameLimiter)
+            pacer::limitFrame();
+        timing::record(timing::STAGE_SLEEP, timing::now() - start);
 
         if (requestSave)
         {
@@ -63,25 +223,243 @@ void runCore()
             core::loadState();
             requestLoad = false;
         }
+        else if (requestTrace)
+        {
+            core::dumpTrace();
+            requestTrace = false;
+        }
+        else if (requestEvents)
+        {
+            core::dumpEvents();
+            requestEvents = false;
+        }
+        else if (requestTiming)
+        {
+            core::dumpTiming();
+            requestTiming = false;
+        }
     }
 }
 
-void draw()
+// Resolves 8-bit palette indices to colors; GLSL 1.10 so it also runs on Mesa's software rasterizers
+const char *paletteShader =
+    "uniform sampler2D indices;\n"
+    "uniform sampler2D palette;\n"
+    "void main()\n"
+    "{\n"
+    "    float index = texture2D(indices, gl_TexCoord[0].st).r * 255.0;\n"
+    "    gl_FragColor = texture2D(palette, vec2((index + 0.5) / 64.0, 0.5));\n"
+    "}\n";
+
+const GLfloat vertices[] =
+{
+    // X,  Y, U, V
+     1, -1, 1, 1,
+    -1, -1, 0, 1,
+    -1,  1, 0, 0,
+     1,  1, 1, 0
+};
+
+bool initPaletteShader()
 {
-    mutex::lock(ppu::displayMutex);
-    if (cropOverscan)
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 256, 224, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, &ppu::displayBuffer[256 * 8]);
+    // Compile and link the palette lookup shader
+    GLuint shader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(shader, 1, &paletteShader, NULL);
+    glCompileShader(shader);
+    GLint status;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (!status)
+        return false;
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (!status)
+        return false;
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "indices"), 0);
+    glUniform1i(glGetUniformLocation(program, "palette"), 1);
+
+    // Upload the palette to its own texture on the second texture unit
+    GLuint paletteTexture;
+    glGenTextures(1, &paletteTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, paletteTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 0x40, 1, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, ppu::palette);
+    glActiveTexture(GL_TEXTURE0);
+
+    return true;
+}
+
+void initRenderer()
+{
+    // Use the palette shader if enabled and supported
+    indexedUpload = shaderPalette && initPaletteShader();
+    if (shaderPalette && !indexedUpload)
+        printf("Failed to set up the palette shader, falling back to RGBA uploads.\n");
+
+    // Allocate the screen texture once; frames are streamed into it afterwards
+    // Indices can't be interpolated, so filtering is only possible with RGBA uploads
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (screenFiltering && !indexedUpload) ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (screenFiltering && !indexedUpload) ? GL_LINEAR : GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (indexedUpload)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8, 256, 240, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, NULL);
     else
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 256, 240, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, ppu::displayBuffer);
-    mutex::unlock(ppu::displayMutex);
-    glBegin(GL_QUADS);
-    glTexCoord2i(1, 1); glVertex2f( 1, -1);
-    glTexCoord2i(0, 1); glVertex2f(-1, -1);
-    glTexCoord2i(0, 0); glVertex2f(-1,  1);
-    glTexCoord2i(1, 0); glVertex2f( 1,  1);
-    glEnd();
-    glFlush();
-    glutPostRedisplay();
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 256, 240, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, NULL);
+
+    glGenBuffers(1, &pixelBuffer);
+
+    // Only sample the rows that frames are uploaded to when overscan is cropped
+    glMatrixMode(GL_TEXTURE);
+    glScalef(1.0f, (cropOverscan ? 224 : 240) / 240.0f, 1.0f);
+
+    // Keep the screen quad in a vertex buffer
+    GLuint vertexBuffer;
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glVertexPointer(2, GL_FLOAT, 4 * sizeof(GLfloat), (void*)0);
+    glTexCoordPointer(2, GL_FLOAT, 4 * sizeof(GLfloat), (void*)(2 * sizeof(GLfloat)));
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+void drawHud()
+{
+    // Switch to untextured fixed-function drawing for the text
+    GLint program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glUseProgram(0);
+    glDisable(GL_TEXTURE_2D);
+
+    // Darken a panel along the top to keep the text readable over the game, with lines 14 pixels apart
+    int height = glutGet(GLUT_WINDOW_HEIGHT);
+    int panel = (timing::STAGE_COUNT + 1) * 14 + 6;
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+    glRectf(-1.0f, 1.0f, 1.0f, 1.0f - 2.0f * panel / height);
+    glDisable(GL_BLEND);
+
+    // List the recent frame times of each stage in milliseconds
+    glColor3f(1.0f, 1.0f, 1.0f);
+    for (int i = -1; i < timing::STAGE_COUNT; i++)
+    {
+        char line[64];
+        if (i < 0)
+        {
+            snprintf(line, sizeof(line), "%-8s %6s %6s %6s", "ms", "p50", "p99", "max");
+        }
+        else
+        {
+            timing::Summary summary = timing::summarize((timing::Stage)i);
+            snprintf(line, sizeof(line), "%-8s %6.2f %6.2f %6.2f", timing::stageNames[i],
+                summary.p50 / 1000000.0f, summary.p99 / 1000000.0f, summary.max / 1000000.0f);
+        }
+        glWindowPos2i(4, height - (i + 2) * 14);
+        for (char *c = line; *c; c++)
+            glutBitmapCharacter(GLUT_BITMAP_8_BY_13, *c);
+    }
+
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glEnable(GL_TEXTURE_2D);
+    glUseProgram(program);
+}
+
+void draw()
+{
+    uint64_t start = timing::now();
+    int offset = cropOverscan ? 256 * 8 : 0;
+    int height = cropOverscan ? 224 : 240;
+    GLsizeiptr size = 256 * height * (indexedUpload ? sizeof(uint8_t) : sizeof(uint32_t));
+
+    // Orphan the pixel buffer so the driver doesn't have to wait on the previous upload
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+
+    // Copy the frame into the pixel buffer
+    void *data = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (data)
+    {
+        mutex::lock(ppu::displayMutex);
+        if (indexedUpload)
+            memcpy(data, &ppu::displayIndices[offset], size);
+        else
+            memcpy(data, &ppu::displayBuffer[offset], size);
+        mutex::unlock(ppu::displayMutex);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        // Update the existing texture from the pixel buffer
+        if (indexedUpload)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, height, GL_LUMINANCE, GL_UNSIGNED_BYTE, (void*)0);
+        else
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, (void*)0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    if (timingHud)
+        drawHud();
+    glutSwapBuffers();
+    timing::record(timing::STAGE_PRESENT, timing::now() - start);
+}
+
+void waitFrame()
+{
+    // Sleep until the core publishes a new frame, waking up regularly to handle window events
+    std::unique_lock<std::mutex> lock(frameMutex);
+    if (frameSignal.wait_for(lock, std::chrono::milliseconds(16), [] { return frameReady; }))
+    {
+        frameReady = false;
+        glutPostRedisplay();
+    }
+}
+
+bool hasGlxExtension(Display *display, const char *name)
+{
+    // Check the space-separated list of GLX extensions for a whole name
+    const char *extensions = glXQueryExtensionsString(display, DefaultScreen(display));
+    size_t length = strlen(name);
+    for (const char *found = extensions; found && (found = strstr(found, name)); found += length)
+    {
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+void setSwapInterval(int interval)
+{
+    // Set the swap interval through whichever GLX extension is available; the SGI one can't set an interval of 0, so
+    // it's only a fallback for turning vsync on
+    Display *display = glXGetCurrentDisplay();
+    typedef void (*SwapIntervalExt)(Display*, GLXDrawable, int);
+    typedef int (*SwapInterval)(int);
+    SwapIntervalExt swapIntervalExt = (SwapIntervalExt)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalEXT");
+    SwapInterval swapIntervalMesa = (SwapInterval)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalMESA");
+    SwapInterval swapIntervalSgi = (SwapInterval)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalSGI");
+
+    if (display && swapIntervalExt && hasGlxExtension(display, "GLX_EXT_swap_control"))
+    {
+        swapIntervalExt(display, glXGetCurrentDrawable(), interval);
+        return;
+    }
+    if (display && swapIntervalMesa && hasGlxExtension(display, "GLX_MESA_swap_control") &&
+        swapIntervalMesa(interval) == 0)
+        return;
+    if (display && swapIntervalSgi && interval > 0 && hasGlxExtension(display, "GLX_SGI_swap_control") &&
+        swapIntervalSgi(interval) == 0)
+        return;
+
+    printf("Failed to turn vsync %s: no GLX extension could set a swap interval of %d\n",
+        interval ? "on" : "off", interval);
 }
 
 void keyDown(unsigned char key, int x, int y)
@@ -105,9 +483,18 @@ void keyUp(unsigned char key, int x, int y)
 int audioCallback(const void *in, void *out, unsigned long frames,
                   const PaStreamCallbackTimeInfo *info, PaStreamCallbackFlags flags, void *data)
 {
+    // Place the audio thread on its first callback, since PortAudio creates it
+    static bool placed = false;
+    if (!placed)
+    {
+        setThreadPlacement(1);
+        placed = true;
+    }
+
     int16_t *curOut = (int16_t*)out;
     for (int i = 0; i < frames; i++)
         *curOut++ = apu::audioSample(2.5f);
+    pacer::consumeSamples(frames);
     return 0;
 }
 
@@ -115,14 +502,38 @@ void onMenuSelect(int selection)
 {
     if (selection == 0) // Save State
         requestSave = true;
-    else // Load State
+    else if (selection == 1) // Load State
         requestLoad = true;
+    else if (selection == 2) // Toggle JIT
+        config::jit = !config::jit;
+    else if (selection == 3) // Dump Trace
+        requestTrace = true;
+    else if (selection == 4) // Break
+        requestBreak = true;
+    else if (selection == 5) // Continue
+        requestContinue = true;
+    else if (selection == 6) // Step
+        requestStep = true;
+    else if (selection == 7) // Dump Events
+        requestEvents = true;
+    else if (selection == 8) // Toggle Timing HUD
+        timingHud = !timingHud;
+    else // Dump Timing
+        requestTiming = true;
 }
 
 void onExit()
 {
     core::closeRom();
     config::save();
+
+    // Report how closely the frame limiter kept to its deadlines
+    if (pacer::stats.frames > 1)
+    {
+        printf("Frame pacing: %u frames, %u missed, %u resyncs, jitter avg %lld ns, max %lld ns\n",
+            pacer::stats.frames, pacer::stats.missed, pacer::stats.resyncs,
+            (long long)(pacer::stats.totalJitter / pacer::stats.frames), (long long)pacer::stats.maxJitter);
+    }
 }
 
 int main(int argc, char **argv)
@@ -137,19 +548,20 @@ int main(int argc, char **argv)
 
     if (core::loadRom(argv[1]) != 0)
         return 1;
+    setDebugPoints();
 
     glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE);
     glutInitWindowSize(256, (cropOverscan ? 224 : 240));
     glutCreateWindow("NoiES");
     glEnable(GL_TEXTURE_2D);
 
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, screenFiltering ? GL_LINEAR : GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, screenFiltering ? GL_LINEAR : GL_NEAREST);
+    // Lock presentation to the display refresh if enabled, otherwise don't let swaps block
+    setSwapInterval(vsync ? 1 : 0);
+    initRenderer();
 
     PaStream *stream;
+    pacer::setSampleRate(44100);
     Pa_Initialize();
     Pa_OpenDefaultStream(&stream, 0, 1, paInt16, 44100, 256, audioCallback, NULL);
     Pa_StartStream(stream);
@@ -157,14 +569,28 @@ int main(int argc, char **argv)
     glutCreateMenu(onMenuSelect);
     glutAddMenuEntry("Save State", 0);
     glutAddMenuEntry("Load State", 1);
+    glutAddMenuEntry("Toggle JIT", 2);
+    if (config::trace)
+        glutAddMenuEntry("Dump Trace", 3);
+    glutAddMenuEntry("Break", 4);
+    glutAddMenuEntry("Continue", 5);
+    glutAddMenuEntry("Step", 6);
+    if (config::busEvents)
+        glutAddMenuEntry("Dump Events", 7);
+    glutAddMenuEntry("Toggle Timing HUD", 8);
+    glutAddMenuEntry("Dump Timing", 9);
     glutAttachMenu(GLUT_RIGHT_BUTTON);
 
     atexit(onExit);
     glutDisplayFunc(draw);
+    glutIdleFunc(waitFrame);
     glutKeyboardFunc(keyDown);
     glutKeyboardUpFunc(keyUp);
 
     std::thread core(runCore);
+
+    // Place this thread last, since the core and audio threads would otherwise inherit its placement
+    setThreadPlacement(2);
     glutMainLoop();
 
     return 0;
@@ -0,0 +1,137 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <vector>
+
+#include "events.h"
+#include "ppu.h"
+
+namespace events
+{
+
+// The register writes of the frame in progress, and of the last finished frame, along with their numbers
+vector<Event> current, last;
+uint32_t currentFrame, lastFrame;
+
+void reset()
+{
+    // Clear both frames, keeping room for a busy frame's worth of writes
+    current.clear();
+    last.clear();
+    current.reserve(0x1000);
+    last.reserve(0x1000);
+    currentFrame = 1;
+    lastFrame = 0;
+}
+
+void record(uint16_t address, uint8_t value)
+{
+    // Note a register write along with the frame and where the PPU is in it
+    Event event = { currentFrame, ppu::scanline, ppu::scanlineDot, address, value };
+    current.push_back(event);
+}
+
+void endFrame(uint32_t frame)
+{
+    // Keep the finished frame for exporting and start a new one, reusing the old buffer
+    last.swap(current);
+    current.clear();
+    lastFrame = frame;
+    currentFrame = frame + 1;
+}
+
+const char *registerName(uint16_t address)
+{
+    // Name the register an address belongs to
+    const char *ppuNames[] = { "PPUCTRL", "PPUMASK", "PPUSTATUS", "OAMADDR", "OAMDATA", "PPUSCROLL", "PPUADDR", "PPUDATA" };
+    if (address < 0x4000)
+        return ppuNames[address & 0x07];
+    else if (address == 0x4014)
+        return "OAMDMA";
+    else if (address == 0x4016)
+        return "JOYPAD";
+    else if (address < 0x4018)
+        return "APU";
+    return "MAPPER";
+}
+
+uint32_t color(uint16_t address)
+{
+    // Give each PPU register, the APU, OAM DMA and the mapper their own color
+    const uint32_t ppuColors[] = { 0xFF4040, 0xFFA040, 0xFFFF40, 0x40FF40, 0x40FFC0, 0x40C0FF, 0x4060FF, 0xC060FF };
+    if (address < 0x4000)
+        return ppuColors[address & 0x07];
+    else if (address == 0x4014)
+        return 0xFFFFFF;
+    else if (address == 0x4016)
+        return 0x808080;
+    else if (address < 0x4018)
+        return 0xFF80C0;
+    return 0xFF40FF;
+}
+
+void write(string romName)
+{
+    // Write the last finished frame's events as a CSV
+    FILE *csv = fopen((romName + ".events.csv").c_str(), "w");
+    if (!csv)
+        return;
+    fprintf(csv, "frame,scanline,dot,address,value,register\n");
+    for (unsigned int i = 0; i < last.size(); i++)
+    {
+        fprintf(csv, "%u,%u,%u,%04X,%02X,%s\n", last[i].frame, last[i].scanline, last[i].scanlineDot,
+            last[i].address, last[i].value, registerName(last[i].address));
+    }
+    fclose(csv);
+
+    // Shade the map by frame region: visible lines, horizontal blank, vertical blank and the pre-render line
+    vector<uint32_t> image(341 * 262);
+    for (int y = 0; y < 262; y++)
+    {
+        for (int x = 0; x < 341; x++)
+        {
+            uint32_t shade = (y >= 240 && y < 261) ? 0x101830 : (y == 261) ? 0x301818 : 0x202020;
+            image[y * 341 + x] = (x == 0 || x > 256) ? shade + 0x101010 : shade;
+        }
+    }
+
+    // Plot each event at its scanline and dot, with later events on the same dot drawn over earlier ones
+    for (unsigned int i = 0; i < last.size(); i++)
+    {
+        if (last[i].scanline < 262 && last[i].scanlineDot < 341)
+            image[last[i].scanline * 341 + last[i].scanlineDot] = color(last[i].address);
+    }
+
+    // Write the map as a binary PPM
+    FILE *ppm = fopen((romName + ".events.ppm").c_str(), "wb");
+    if (!ppm)
+        return;
+    fprintf(ppm, "P6\n341 262\n255\n");
+    for (unsigned int i = 0; i < image.size(); i++)
+    {
+        uint8_t pixel[] = { (uint8_t)(image[i] >> 16), (uint8_t)(image[i] >> 8), (uint8_t)image[i] };
+        fwrite(pixel, 1, 3, ppm);
+    }
+    fclose(ppm);
+
+    printf("Wrote %u bus events from frame %u\n", (unsigned int)last.size(), lastFrame);
+}
+
+}
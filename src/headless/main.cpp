@@ -0,0 +1,197 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// A headless runner that emulates a ROM as fast as possible, without video, audio or input
+// Usage: noies-headless rom.nes [frames] [-l] [-b]
+// Settings are taken from noies.ini as with the desktop frontend; -l lists the lag frames as ranges
+// -b is the bench mode, which reads performance counters on Linux and charges them to the phases of the core;
+// the per-frame counts are also written to rom.perf.csv
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "../core.h"
+#include "../config.h"
+#include "../perf.h"
+#include "../timing.h"
+
+// The sampling period of the bench mode, in nanoseconds of thread CPU time
+const uint32_t samplePeriod = 250000;
+
+void reportCounters(string romName)
+{
+    const vector<perf::Frame> &frames = perf::frames;
+    if (frames.empty())
+        return;
+
+    // Sum the exact totals and the sampled phase counts over the run
+    perf::Frame sum;
+    memset(&sum, 0, sizeof(sum));
+    for (unsigned int i = 0; i < frames.size(); i++)
+    {
+        for (int j = 0; j < perf::COUNTER_COUNT; j++)
+        {
+            sum.totals[j] += frames[i].totals[j];
+            for (int k = 0; k < perf::PHASE_COUNT; k++)
+                sum.phases[k][j] += frames[i].phases[k][j];
+        }
+    }
+
+    // Print each counter per frame, split by phase in proportion to the samples charged to it
+    printf("\n%-14s %12s", "Counter", "Per frame");
+    for (int k = 0; k < perf::PHASE_COUNT; k++)
+        printf(" %8s", perf::phaseNames[k]);
+    printf("\n");
+    for (int j = 0; j < perf::COUNTER_COUNT; j++)
+    {
+        if (!perf::available[j])
+        {
+            printf("%-14s %12s\n", perf::counterNames[j], "n/a");
+            continue;
+        }
+
+        uint64_t sampled = 0;
+        for (int k = 0; k < perf::PHASE_COUNT; k++)
+            sampled += sum.phases[k][j];
+        printf("%-14s %12.0f", perf::counterNames[j], (double)sum.totals[j] / frames.size());
+        for (int k = 0; k < perf::PHASE_COUNT; k++)
+            printf(" %7.1f%%", sampled ? sum.phases[k][j] * 100.0 / sampled : 0.0);
+        printf("\n");
+    }
+
+    // Derive the ratios that explain a change in speed
+    uint64_t instructions = sum.totals[perf::COUNT_INSTRUCTIONS];
+    if (perf::available[perf::COUNT_CYCLES] && instructions)
+    {
+        printf("\nInstructions per cycle: %.2f\n", (double)instructions / sum.totals[perf::COUNT_CYCLES]);
+        printf("Branch misses per 1000 instructions: %.2f\n", sum.totals[perf::COUNT_BRANCH_MISSES] * 1000.0 / instructions);
+        printf("Cache misses per 1000 instructions: %.2f\n", sum.totals[perf::COUNT_CACHE_MISSES] * 1000.0 / instructions);
+    }
+
+    // Write the counts of every frame, with a column for each phase of each available counter
+    FILE *csv = fopen((romName + ".perf.csv").c_str(), "w");
+    if (!csv)
+        return;
+    fprintf(csv, "frame");
+    for (int j = 0; j < perf::COUNTER_COUNT; j++)
+    {
+        if (!perf::available[j])
+            continue;
+        fprintf(csv, ",%s", perf::counterNames[j]);
+        for (int k = 0; k < perf::PHASE_COUNT; k++)
+            fprintf(csv, ",%s %s", perf::phaseNames[k], perf::counterNames[j]);
+    }
+    fprintf(csv, "\n");
+    for (unsigned int i = 0; i < frames.size(); i++)
+    {
+        fprintf(csv, "%u", i + 1);
+        for (int j = 0; j < perf::COUNTER_COUNT; j++)
+        {
+            if (!perf::available[j])
+                continue;
+            fprintf(csv, ",%llu", (unsigned long long)frames[i].totals[j]);
+            for (int k = 0; k < perf::PHASE_COUNT; k++)
+                fprintf(csv, ",%llu", (unsigned long long)frames[i].phases[k][j]);
+        }
+        fprintf(csv, "\n");
+    }
+    fclose(csv);
+    printf("Wrote the counts of each frame to %s.perf.csv\n", romName.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s rom.nes [frames] [-l] [-b]\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t frames = 600;
+    bool listLag = false, bench = false;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-l") == 0)
+            listLag = true;
+        else if (strcmp(argv[i], "-b") == 0)
+            bench = true;
+        else
+            frames = strtoul(argv[i], nullptr, 0);
+    }
+
+    config::load(vector<config::Setting>());
+    if (core::loadRom(argv[1]) != 0)
+        return 1;
+
+    // Start the performance counters on this thread, which runs the emulation
+    if (bench && !perf::start(samplePeriod))
+        bench = false;
+
+    // Run the frames, noting which ones were lag
+    vector<bool> lag(frames);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        core::runFrame();
+        lag[i] = core::lagFrame;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    perf::stop();
+    core::closeRom();
+
+    printf("Ran %u frames in %.3f s (%.1f fps)\n", frames, seconds, frames / seconds);
+    printf("Lag frames: %u (%.1f%%)\n", core::lagFrames, frames ? core::lagFrames * 100.0 / frames : 0.0);
+
+    // Show where the time of each frame went, leaving out presenting and sleeping since neither happens here
+    printf("\n%-8s %8s %8s %8s\n", "Stage", "p50 ms", "p99 ms", "max ms");
+    for (int i = 0; i < timing::STAGE_PRESENT; i++)
+    {
+        timing::Summary summary = timing::summarize((timing::Stage)i);
+        printf("%-8s %8.3f %8.3f %8.3f\n", timing::stageNames[i],
+            summary.p50 / 1000000.0, summary.p99 / 1000000.0, summary.max / 1000000.0);
+    }
+    if (bench)
+    {
+        string romName = argv[1];
+        reportCounters(romName.substr(0, romName.rfind(".")));
+    }
+
+    // List the lag frames, numbered from 1, with consecutive ones joined into ranges
+    if (listLag)
+    {
+        for (uint32_t i = 0; i < frames; i++)
+        {
+            if (!lag[i])
+                continue;
+            uint32_t end = i;
+            while (end + 1 < frames && lag[end + 1])
+                end++;
+            if (end == i)
+                printf("  %u\n", i + 1);
+            else
+                printf("  %u-%u\n", i + 1, end + 1);
+            i = end;
+        }
+    }
+
+    return 0;
+}
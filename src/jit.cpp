@@ -0,0 +1,842 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "core.h"
+#include "config.h"
+#include "cpu.h"
+#include "jit.h"
+#include "opcodes.h"
+
+namespace jit
+{
+
+#if defined(__x86_64__) && defined(__linux__)
+
+typedef void (*Code)();
+
+typedef struct
+{
+    Code code;
+    uint32_t generation;
+    uint16_t hits;
+} Block;
+
+typedef struct
+{
+    uint16_t targetCycles;
+    uint16_t programCounter;
+    uint8_t accumulator, registerX, registerY;
+    uint8_t flags;
+    uint8_t stackPointer;
+    uint8_t memory[0x10000];
+} State;
+
+// How many times an address runs through the interpreter before it's compiled
+const uint16_t threshold = 16;
+
+// The most instructions in a block, and the most code a block can take up
+const int maxLength = 64;
+const uint32_t maxBlockSize = 0x4000;
+
+const uint32_t bufferSize = 0x400000;
+
+Block blocks[0x10000];
+uint8_t *buffer, *emitPtr;
+uint32_t bufferOffset;
+bool initialized, unavailable;
+
+uint16_t executed;
+
+// The cycle count a block can reach before the PPU or APU could raise an interrupt, past which it has to exit
+uint32_t limit;
+
+State before, after;
+
+int32_t offset(const void *pointer)
+{
+    // Get the displacement of a variable from the CPU memory, which compiled code keeps in RBP
+    return (const uint8_t*)pointer - cpu::memory;
+}
+
+bool init()
+{
+    // Make sure that everything compiled code touches can be reached from the CPU memory with a 32-bit displacement
+    const void *variables[] = { &cpu::targetCycles, &cpu::programCounter, &cpu::accumulator, &cpu::registerX, &cpu::registerY,
+                                &cpu::flags, &cpu::nzResult, &cpu::stackPointer, cpu::pages, &cpu::pages[0xFF], cpu::generations, &executed, &limit };
+    for (unsigned int i = 0; i < sizeof(variables) / sizeof(variables[0]); i++)
+    {
+        int64_t distance = (const uint8_t*)variables[i] - cpu::memory;
+        if (distance != (int32_t)distance)
+        {
+            printf("JIT unavailable: CPU state is out of range\n");
+            return false;
+        }
+    }
+
+    // Allocate memory to hold compiled code, which is never writable and executable at the same time
+    buffer = (uint8_t*)mmap(nullptr, bufferSize, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED)
+    {
+        printf("JIT unavailable: failed to allocate executable memory\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool protect(int protection)
+{
+    // Change the protection of the pages that the next block can be emitted to
+    uint32_t start = bufferOffset & ~(sysconf(_SC_PAGESIZE) - 1);
+    if (mprotect(&buffer[start], bufferOffset + maxBlockSize - start, protection) == 0)
+        return true;
+
+    printf("JIT unavailable: failed to change the protection of compiled code\n");
+    unavailable = true;
+    return false;
+}
+
+void emit8(uint8_t value)
+{
+    // Write a byte of code
+    *emitPtr++ = value;
+}
+
+void emit16(uint16_t value)
+{
+    // Write a 16-bit value of code
+    memcpy(emitPtr, &value, sizeof(value));
+    emitPtr += sizeof(value);
+}
+
+void emit32(uint32_t value)
+{
+    // Write a 32-bit value of code
+    memcpy(emitPtr, &value, sizeof(value));
+    emitPtr += sizeof(value);
+}
+
+void emit64(uint64_t value)
+{
+    // Write a 64-bit value of code
+    memcpy(emitPtr, &value, sizeof(value));
+    emitPtr += sizeof(value);
+}
+
+void emitAddress(uint8_t reg, const void *pointer)
+{
+    // Address a variable as [RBP + disp32]
+    emit8(0x85 | (reg << 3));
+    emit32(offset(pointer));
+}
+
+void emitIndexed(uint8_t reg, uint8_t index, const void *pointer)
+{
+    // Address an array element as [RBP + index + disp32]
+    emit8(0x84 | (reg << 3));
+    emit8((index << 3) | 0x05);
+    emit32(offset(pointer));
+}
+
+// x86 register numbers; AL-DL and DH for byte operations
+enum Register
+{
+    EAX = 0, ECX = 1, EDX = 2, ESI = 6, EDI = 7, DH = 6
+};
+
+void loadByte(uint8_t reg, const void *pointer)
+{
+    // movzx reg, byte [pointer]
+    emit8(0x0F); emit8(0xB6);
+    emitAddress(reg, pointer);
+}
+
+void storeByte(uint8_t reg, const void *pointer)
+{
+    // mov byte [pointer], reg
+    emit8(0x88);
+    emitAddress(reg, pointer);
+}
+
+void storeImmediate(const void *pointer, uint8_t value)
+{
+    // mov byte [pointer], value
+    emit8(0xC6);
+    emitAddress(0, pointer);
+    emit8(value);
+}
+
+void andImmediate(const void *pointer, uint8_t value)
+{
+    // and byte [pointer], value
+    emit8(0x80);
+    emitAddress(4, pointer);
+    emit8(value);
+}
+
+void orImmediate(const void *pointer, uint8_t value)
+{
+    // or byte [pointer], value
+    emit8(0x80);
+    emitAddress(1, pointer);
+    emit8(value);
+}
+
+void moveImmediate(uint8_t reg, uint32_t value)
+{
+    // mov reg, value
+    emit8(0xB8 | reg);
+    emit32(value);
+}
+
+void call(const void *function)
+{
+    // movabs rax, function; call rax
+    emit8(0x48); emit8(0xB8);
+    emit64((uint64_t)function);
+    emit8(0xFF); emit8(0xD0);
+}
+
+uint8_t *jump(uint8_t condition)
+{
+    // Emit a conditional jump (or an unconditional one if the condition is 0xFF), returning the offset to patch
+    if (condition == 0xFF)
+    {
+        emit8(0xE9);
+    }
+    else
+    {
+        emit8(0x0F);
+        emit8(0x80 | condition);
+    }
+    emit32(0);
+    return emitPtr - 4;
+}
+
+void patch(uint8_t *jump)
+{
+    // Point a jump at the current position
+    int32_t distance = emitPtr - (jump + 4);
+    memcpy(jump, &distance, sizeof(distance));
+}
+
+// x86 condition codes
+const uint8_t JE = 0x4, JNE = 0x5, JBE = 0x6;
+
+void setNZ()
+{
+    // Keep AL as the result that the N and Z flags are derived from
+    emit8(0x0F); emit8(0xB6); emit8(0xC0);                      // movzx eax, al
+    emit8(0x66); emit8(0x89); emitAddress(EAX, &cpu::nzResult); // mov word [nzResult], ax
+}
+
+void setNZC()
+{
+    // Set the N and Z flags from AL and the C flag from DL
+    setNZ();
+    andImmediate(&cpu::flags, 0xFE);
+    emit8(0x08); emitAddress(EDX, &cpu::flags); // or [flags], dl
+}
+
+void loadCarry()
+{
+    // Move the C flag into the host carry flag
+    loadByte(EDX, &cpu::flags);
+    emit8(0xD0); emit8(0xEA); // shr dl, 1
+}
+
+void zeroPageIndex(cpu::Mode mode, uint8_t operand)
+{
+    // Put an indexed zero page address in ECX
+    loadByte(ECX, (mode == cpu::ZPX) ? &cpu::registerX : &cpu::registerY);
+    emit8(0x80); emit8(0xC1); emit8(operand); // add cl, operand
+    emit8(0x0F); emit8(0xB6); emit8(0xC9);    // movzx ecx, cl
+}
+
+void loadOperand(cpu::Mode mode, uint16_t operand)
+{
+    // Load the value of an operand into AL
+    switch (mode)
+    {
+        case cpu::IMM:
+            moveImmediate(EAX, operand);
+            break;
+
+        case cpu::ZPG:
+            loadByte(EAX, &cpu::memory[operand]);
+            break;
+
+        case cpu::ZPX: case cpu::ZPY:
+            zeroPageIndex(mode, operand);
+            emit8(0x0F); emit8(0xB6); emitIndexed(EAX, ECX, cpu::memory); // movzx eax, [memory + rcx]
+            break;
+
+        default: // Absolute
+            if (operand < 0x2000)
+            {
+                loadByte(EAX, &cpu::memory[operand & 0x7FF]);
+            }
+            else
+            {
+                moveImmediate(EDI, operand);
+                call((const void*)cpu::memoryRead);
+            }
+            break;
+    }
+}
+
+void storeOperand(cpu::Mode mode, uint16_t operand)
+{
+    // Store AL to the address of an operand, going through memoryWrite if the page holds decoded code
+    if (mode == cpu::ZPX || mode == cpu::ZPY)
+        zeroPageIndex(mode, operand);
+    else
+        moveImmediate(ECX, (operand < 0x2000) ? (operand & 0x7FF) : operand);
+
+    uint8_t *done = nullptr;
+    if (operand < 0x2000)
+    {
+        emit8(0x80); emitAddress(7, &cpu::pages[operand >> 8].code); emit8(0x00); // cmp byte [code], 0
+        uint8_t *slow = jump(JNE);
+        emit8(0x88); emitIndexed(EAX, ECX, cpu::memory); // mov [memory + rcx], al
+        done = jump(0xFF);
+        patch(slow);
+    }
+
+    // Keep AL and DL across the call
+    emit8(0x50); emit8(0x52);              // push rax; push rdx
+    emit8(0x89); emit8(0xCF);              // mov edi, ecx
+    emit8(0x0F); emit8(0xB6); emit8(0xF0); // movzx esi, al
+    call((const void*)cpu::memoryWrite);
+    emit8(0x5A); emit8(0x58);              // pop rdx; pop rax
+
+    if (done)
+        patch(done);
+}
+
+uint8_t *registerFor(cpu::Operation operation)
+{
+    // Get the register that a load, store, compare, increment or decrement operates on
+    switch (operation)
+    {
+        case cpu::LDX: case cpu::STX: case cpu::CPX: case cpu::INX: case cpu::DEX: return &cpu::registerX;
+        case cpu::LDY: case cpu::STY: case cpu::CPY: case cpu::INY: case cpu::DEY: return &cpu::registerY;
+        default: return &cpu::accumulator;
+    }
+}
+
+bool emitNative(const cpu::Opcode *opcode, uint16_t operand)
+{
+    // Emit native code for the common instructions, or return false to have the block call the interpreter's handler
+    cpu::Mode mode = opcode->mode;
+    if (mode == cpu::ABX || mode == cpu::ABY || mode == cpu::IND || mode == cpu::IZX || mode == cpu::IZY)
+        return false;
+
+    uint8_t *reg = registerFor(opcode->operation);
+    switch (opcode->operation)
+    {
+        case cpu::LDA: case cpu::LDX: case cpu::LDY:
+            loadOperand(mode, operand);
+            storeByte(EAX, reg);
+            setNZ();
+            return true;
+
+        case cpu::STA: case cpu::STX: case cpu::STY:
+            loadByte(EAX, reg);
+            storeOperand(mode, operand);
+            return true;
+
+        case cpu::AND: case cpu::ORA: case cpu::EOR:
+            loadOperand(mode, operand);
+            emit8((opcode->operation == cpu::AND) ? 0x22 : (opcode->operation == cpu::ORA) ? 0x0A : 0x32);
+            emitAddress(EAX, &cpu::accumulator); // and/or/xor al, [accumulator]
+            storeByte(EAX, &cpu::accumulator);
+            setNZ();
+            return true;
+
+        case cpu::ADC: case cpu::SBC:
+            loadOperand(mode, operand);
+            loadByte(ECX, &cpu::accumulator);
+            loadCarry();
+            if (opcode->operation == cpu::ADC)
+            {
+                emit8(0x10); emit8(0xC1);              // adc cl, al
+                emit8(0x0F); emit8(0x92); emit8(0xC2); // setc dl
+            }
+            else
+            {
+                emit8(0xF5);                           // cmc
+                emit8(0x18); emit8(0xC1);              // sbb cl, al
+                emit8(0x0F); emit8(0x93); emit8(0xC2); // setnc dl
+            }
+            emit8(0x0F); emit8(0x90); emit8(0xC6);     // seto dh
+            storeByte(ECX, &cpu::accumulator);
+            emit8(0xC0); emit8(0xE6); emit8(0x06);     // shl dh, 6
+            emit8(0x08); emit8(0xF2);                  // or dl, dh
+            andImmediate(&cpu::flags, 0xBF);
+            emit8(0x88); emit8(0xC8);                  // mov al, cl
+            setNZC();
+            return true;
+
+        case cpu::CMP: case cpu::CPX: case cpu::CPY:
+            loadOperand(mode, operand);
+            loadByte(ECX, reg);
+            emit8(0x28); emit8(0xC1);              // sub cl, al
+            emit8(0x0F); emit8(0x93); emit8(0xC2); // setae dl
+            emit8(0x88); emit8(0xC8);              // mov al, cl
+            setNZC();
+            return true;
+
+        case cpu::INC: case cpu::DEC:
+            loadOperand(mode, operand);
+            emit8(0xFE); emit8((opcode->operation == cpu::INC) ? 0xC0 : 0xC8); // inc/dec al
+            storeOperand(mode, operand);
+            setNZ();
+            return true;
+
+        case cpu::INX: case cpu::INY: case cpu::DEX: case cpu::DEY:
+            loadByte(EAX, reg);
+            emit8(0xFE); emit8((opcode->operation == cpu::INX || opcode->operation == cpu::INY) ? 0xC0 : 0xC8);
+            storeByte(EAX, reg);
+            setNZ();
+            return true;
+
+        case cpu::ASL: case cpu::LSR: case cpu::ROL: case cpu::ROR:
+        {
+            const uint8_t shifts[] = { 0xE0, 0xE8, 0xD0, 0xD8 }; // shl, shr, rcl, rcr
+            uint8_t shift = shifts[(opcode->operation == cpu::ASL) ? 0 : (opcode->operation == cpu::LSR) ? 1 :
+                                   (opcode->operation == cpu::ROL) ? 2 : 3];
+            if (mode == cpu::ACC)
+                loadByte(EAX, &cpu::accumulator);
+            else
+                loadOperand(mode, operand);
+            if (opcode->operation == cpu::ROL || opcode->operation == cpu::ROR)
+                loadCarry();
+            emit8(0xD0); emit8(shift);             // shift al, 1
+            emit8(0x0F); emit8(0x92); emit8(0xC2); // setc dl
+            if (mode == cpu::ACC)
+                storeByte(EAX, &cpu::accumulator);
+            else
+                storeOperand(mode, operand);
+            setNZC();
+            return true;
+        }
+
+        case cpu::TAX: case cpu::TAY: case cpu::TXA: case cpu::TYA: case cpu::TSX: case cpu::TXS:
+        {
+            cpu::Operation op = opcode->operation;
+            uint8_t *src = (op == cpu::TAX || op == cpu::TAY) ? &cpu::accumulator : (op == cpu::TSX) ? &cpu::stackPointer :
+                           (op == cpu::TYA) ? &cpu::registerY : &cpu::registerX;
+            uint8_t *dst = (op == cpu::TXA || op == cpu::TYA) ? &cpu::accumulator : (op == cpu::TXS) ? &cpu::stackPointer :
+                           (op == cpu::TAY) ? &cpu::registerY : &cpu::registerX;
+            loadByte(EAX, src);
+            storeByte(EAX, dst);
+            if (op != cpu::TXS)
+                setNZ();
+            return true;
+        }
+
+        case cpu::CLC: andImmediate(&cpu::flags, ~0x01); return true;
+        case cpu::CLD: andImmediate(&cpu::flags, ~0x08); return true;
+        case cpu::CLV: andImmediate(&cpu::flags, ~0x40); return true;
+        case cpu::SEC: orImmediate(&cpu::flags, 0x01);   return true;
+        case cpu::SED: orImmediate(&cpu::flags, 0x08);   return true;
+        case cpu::NOP:                                   return true;
+
+        default:
+            return false;
+    }
+}
+
+void emitExit(uint16_t address, int count, uint16_t cycles, bool setCounter = true)
+{
+    // Charge the cycles of natively-run instructions, set where to continue, and return to the interpreter
+    if (cycles)
+    {
+        emit8(0x66); emit8(0x81); emitAddress(0, &cpu::targetCycles); emit16(cycles); // add word [targetCycles], cycles
+    }
+    if (setCounter)
+    {
+        emit8(0x66); emit8(0xC7); emitAddress(0, &cpu::programCounter); emit16(address); // mov word [programCounter], address
+    }
+    emit8(0x66); emit8(0xC7); emitAddress(0, &executed); emit16(count); // mov word [executed], count
+    emit8(0x5D); // pop rbp
+    emit8(0xC3); // ret
+}
+
+int physical(int page)
+{
+    // Get the page that actually backs an address page, since RAM is mirrored
+    return (page < 0x20) ? page % 8 : page;
+}
+
+bool direct(uint16_t first, uint16_t last, cpu::Access access)
+{
+    // Check that every page in an address range is backed by memory for the given kind of access
+    for (int i = first >> 8; i <= (last >> 8); i++)
+    {
+        if ((access != cpu::WRITE && !cpu::pages[i].read) || (access != cpu::READ && !cpu::pages[i].write))
+            return false;
+    }
+    return true;
+}
+
+bool probe(uint16_t address)
+{
+    // Check at runtime that an indexed or indirect access goes to memory, so the block can run it without bailing out
+    const cpu::Opcode *opcode = &cpu::opcodes[cpu::memoryPeek(address)];
+    uint16_t operand = cpu::memoryPeek(address + 1) | (cpu::memoryPeek(address + 2) << 8);
+    uint16_t target;
+
+    switch (opcode->mode)
+    {
+        case cpu::ABX: target = operand + cpu::registerX; break;
+        case cpu::ABY: target = operand + cpu::registerY; break;
+        case cpu::IZX: target = cpu::memory[(uint8_t)(operand + cpu::registerX)] | (cpu::memory[(uint8_t)(operand + cpu::registerX + 1)] << 8); break;
+        default:       target = (cpu::memory[(uint8_t)operand] | (cpu::memory[(uint8_t)(operand + 1)] << 8)) + cpu::registerY; break;
+    }
+
+    return direct(target, target, opcode->access);
+}
+
+Code compile(uint16_t start)
+{
+    // Start over once the code buffer fills up
+    if (bufferOffset + maxBlockSize > bufferSize)
+    {
+        memset(blocks, 0, sizeof(blocks));
+        bufferOffset = 0;
+    }
+
+    // Make the space for the block writable only while it's emitted
+    if (!protect(PROT_READ | PROT_WRITE))
+        return nullptr;
+
+    uint8_t *code = emitPtr = &buffer[bufferOffset];
+    uint32_t generation = cpu::generations[start >> 8];
+    int codePages[] = { physical(start >> 8), physical(((start >> 8) + 1) & 0xFF) };
+
+    // Keep the CPU memory in RBP, which also aligns the stack for calls
+    emit8(0x55);                   // push rbp
+    emit8(0x48); emit8(0xBD);      // movabs rbp, memory
+    emit64((uint64_t)cpu::memory);
+
+    uint16_t address = start;
+    uint16_t cycles = 0;
+    int count = 0;
+    bool ended = false;
+
+    while (count < maxLength && (address >> 8) == (start >> 8))
+    {
+        uint8_t value = cpu::memoryPeek(address);
+        const cpu::Opcode *opcode = &cpu::opcodes[value];
+        uint8_t length = cpu::length(opcode->mode);
+        uint16_t end = address + length - 1;
+        uint16_t next = end + 1;
+        uint16_t operand = (length == 1) ? 0 : (length == 2) ? cpu::memoryPeek(address + 1) :
+                           (cpu::memoryPeek(address + 1) | (cpu::memoryPeek(address + 2) << 8));
+        cpu::Operation operation = opcode->operation;
+        cpu::Access access = opcode->access;
+
+        // Stop at instructions that halt the CPU or that don't lie entirely in memory
+        if (operation == cpu::STP || !cpu::pages[end >> 8].read)
+            break;
+
+        // Exit before an instruction that could run past the next event, so that interrupts are taken at the same
+        // boundary as in the interpreter; the first one always runs, since the interpreter would run it here too
+        if (count > 0)
+        {
+            uint8_t most = opcode->cycles + ((opcode->mode == cpu::REL) ? 2 : 1);
+            emit8(0x0F); emit8(0xB7); emitAddress(EAX, &cpu::targetCycles); // movzx eax, word [targetCycles]
+            emit8(0x05); emit32(cycles + most);                             // add eax, cycles
+            emit8(0x3B); emitAddress(EAX, &limit);                          // cmp eax, [limit]
+            uint8_t *within = jump(JBE);
+            emitExit(address, count, cycles);
+            patch(within);
+        }
+
+        // Find the range of addresses an instruction can access, if it can be known ahead of time
+        uint16_t first = 0, last = 0;
+        bool dynamic = false;
+        switch (opcode->mode)
+        {
+            case cpu::ZPG: first = last = operand; break;
+            case cpu::ZPX: case cpu::ZPY: first = 0x00; last = 0xFF; break;
+            case cpu::ABS: first = last = operand; break;
+            case cpu::IND: first = operand; last = (operand & 0xFF00) | ((operand + 1) & 0xFF); access = cpu::READ; break;
+            case cpu::ABX: case cpu::ABY: first = operand; last = operand + 0xFF; dynamic = (last < first); break;
+            case cpu::IZX: case cpu::IZY: dynamic = true; break;
+            default: access = cpu::OTHER; break;
+        }
+
+        // Treat the stack as the access range of instructions that use it
+        if (operation == cpu::PHA || operation == cpu::PHP || operation == cpu::JSR || operation == cpu::BRK)
+        {
+            first = 0x100; last = 0x1FF;
+            access = cpu::WRITE;
+        }
+
+        // Stop at accesses that might reach registers; indexed ones are checked at runtime instead
+        if (access != cpu::OTHER && !dynamic && !direct(first, last, access))
+        {
+            if (opcode->mode != cpu::ABX && opcode->mode != cpu::ABY)
+                break;
+            dynamic = true;
+        }
+        if (dynamic)
+        {
+            moveImmediate(EDI, address);
+            call((const void*)probe);
+            emit8(0x84); emit8(0xC0); // test al, al
+            uint8_t *safe = jump(JNE);
+            emitExit(address, count, cycles);
+            patch(safe);
+        }
+
+        cpu::markCode(address >> 8);
+        cpu::markCode(end >> 8);
+        count++;
+
+        if (opcode->mode == cpu::REL) // Branches
+        {
+            uint8_t masks[] = { 0x80, 0x80, 0x40, 0x40, 0x01, 0x01, 0x02, 0x02 };
+            cpu::Operation branches[] = { cpu::BPL, cpu::BMI, cpu::BVC, cpu::BVS, cpu::BCC, cpu::BCS, cpu::BNE, cpu::BEQ };
+            int i = 0;
+            while (branches[i] != operation)
+                i++;
+
+            // Exit to the branch target or to the next instruction, charging the extra cycles of a taken branch
+            uint16_t target = next + (int8_t)operand;
+            bool set = (i % 2); // Taken when the flag is set
+            if (i < 2)
+            {
+                // The N flag is bit 7 or bit 15 of the last result
+                emit8(0x66); emit8(0xF7); emitAddress(0, &cpu::nzResult); emit16(0x8080); // test word [nzResult], 0x8080
+            }
+            else if (i >= 6)
+            {
+                // The Z flag is set when the low byte of the last result is zero
+                emit8(0xF6); emitAddress(0, &cpu::nzResult); emit8(0xFF); // test byte [nzResult], 0xFF
+                set = !set;
+            }
+            else
+            {
+                emit8(0xF6); emitAddress(0, &cpu::flags); emit8(masks[i]); // test byte [flags], mask
+            }
+            uint8_t *notTaken = jump(set ? JE : JNE);
+            emitExit(target, count, cycles + opcode->cycles + 1 + ((target & 0xFF00) != (next & 0xFF00)));
+            patch(notTaken);
+            emitExit(next, count, cycles + opcode->cycles);
+            ended = true;
+            break;
+        }
+        else if (operation == cpu::JMP && opcode->mode == cpu::ABS)
+        {
+            emitExit(operand, count, cycles + opcode->cycles);
+            ended = true;
+            break;
+        }
+        else if (emitNative(opcode, operand))
+        {
+            cycles += opcode->cycles;
+        }
+        else
+        {
+            // Call the interpreter's handler, which charges its own cycles and advances the program counter
+            emit8(0x66); emit8(0xC7); emitAddress(0, &cpu::programCounter); emit16(address); // mov word [programCounter], address
+            moveImmediate(EDI, operand);
+            call((const void*)cpu::handlers[value]);
+
+            // End the block after instructions that change the program counter, or that can unmask a pending IRQ
+            if (operation == cpu::JMP || operation == cpu::JSR || operation == cpu::RTS || operation == cpu::RTI || operation == cpu::BRK ||
+                operation == cpu::CLI || operation == cpu::PLP)
+            {
+                emitExit(0, count, cycles, false);
+                ended = true;
+                break;
+            }
+        }
+
+        if (access == cpu::WRITE || access == cpu::RMW)
+        {
+            if (dynamic)
+            {
+                // Exit if a write might have modified the block itself
+                emit8(0x81); emitAddress(7, &cpu::generations[start >> 8]); emit32(generation); // cmp dword [generation], value
+                uint8_t *unchanged = jump(JE);
+                emitExit(next, count, cycles);
+                patch(unchanged);
+            }
+            else
+            {
+                // End the block after a write that can reach its own code
+                bool overlap = false;
+                for (int i = first >> 8; i <= (last >> 8); i++)
+                    overlap |= (physical(i) == codePages[0] || physical(i) == codePages[1]);
+                if (overlap)
+                {
+                    address = next;
+                    break;
+                }
+            }
+        }
+
+        address = next;
+    }
+
+    if (count > 0 && !ended)
+        emitExit(address, count, cycles);
+
+    if (!protect(PROT_READ | PROT_EXEC) || count == 0)
+        return nullptr;
+
+    bufferOffset = emitPtr - buffer;
+    return (Code)code;
+}
+
+void saveState(State *state)
+{
+    // Copy the CPU state that a block can change
+    state->targetCycles = cpu::targetCycles;
+    state->programCounter = cpu::programCounter;
+    state->accumulator = cpu::accumulator;
+    state->registerX = cpu::registerX;
+    state->registerY = cpu::registerY;
+    state->flags = cpu::getFlags();
+    state->stackPointer = cpu::stackPointer;
+    memcpy(state->memory, cpu::memory, sizeof(state->memory));
+}
+
+void loadState(State *state)
+{
+    // Restore the CPU state that a block can change
+    cpu::targetCycles = state->targetCycles;
+    cpu::programCounter = state->programCounter;
+    cpu::accumulator = state->accumulator;
+    cpu::registerX = state->registerX;
+    cpu::registerY = state->registerY;
+    cpu::setFlags(state->flags);
+    cpu::stackPointer = state->stackPointer;
+    memcpy(cpu::memory, state->memory, sizeof(state->memory));
+}
+
+bool verify(Block *block)
+{
+    // Run the block, then run the same instructions through the interpreter from the original state
+    uint16_t address = cpu::programCounter;
+    saveState(&before);
+    block->code();
+    saveState(&after);
+    loadState(&before);
+
+    // Check that the interpreter couldn't have taken an interrupt between the instructions, either because one was
+    // unmasked partway through or because the block ran past the next PPU or APU event
+    int late = 0;
+    for (int i = 0; i < executed; i++)
+    {
+        if (i > 0 && cpu::pendingInterrupts() && !late)
+            late = i;
+        cpu::runInstruction();
+    }
+    if (executed > 1 && cpu::targetCycles > limit && !late)
+        late = executed;
+    if (late)
+    {
+        printf("JIT block at $%04X (%s) ran past a possible interrupt after %d instructions (%d cycles, %d before the next event)\n",
+               address, cpu::disassemble(address).c_str(), late, cpu::targetCycles - before.targetCycles, limit - before.targetCycles);
+    }
+
+    // Report any difference, keeping the interpreter's results
+    saveState(&before);
+    if (memcmp(&before, &after, sizeof(State)) != 0)
+    {
+        printf("JIT mismatch in block at $%04X (%s) after %d instructions\n", address, cpu::disassemble(address).c_str(), executed);
+        printf("  interpreter: PC=%04X A=%02X X=%02X Y=%02X P=%02X S=%02X cycles=%d\n", before.programCounter, before.accumulator,
+               before.registerX, before.registerY, before.flags, before.stackPointer, before.targetCycles);
+        printf("  JIT:         PC=%04X A=%02X X=%02X Y=%02X P=%02X S=%02X cycles=%d\n", after.programCounter, after.accumulator,
+               after.registerX, after.registerY, after.flags, after.stackPointer, after.targetCycles);
+        for (int i = 0; i < 0x10000; i++)
+        {
+            if (before.memory[i] != after.memory[i])
+                printf("  memory[$%04X]: interpreter %02X, JIT %02X\n", i, before.memory[i], after.memory[i]);
+        }
+    }
+
+    return executed > 0;
+}
+
+bool execute()
+{
+    if (!initialized)
+    {
+        unavailable = !init();
+        initialized = true;
+    }
+    if (unavailable)
+        return false;
+
+    // Discard the block if its page has changed since it was compiled
+    uint16_t address = cpu::programCounter;
+    Block *block = &blocks[address];
+    if (block->generation != cpu::generations[address >> 8])
+    {
+        block->code = nullptr;
+        block->generation = cpu::generations[address >> 8];
+        block->hits = 0;
+    }
+
+    // Leave cold code to the interpreter, and compile it once it becomes hot
+    if (!block->code)
+    {
+        if (block->hits > threshold || ++block->hits <= threshold)
+            return false;
+        if (!(block->code = compile(address)))
+            return false;
+        block->generation = cpu::generations[address >> 8];
+    }
+
+    // Let the block run up to where the PPU or APU could next raise an interrupt
+    limit = cpu::targetCycles + cpu::eventCycles();
+    if (config::jit == 2)
+        return verify(block);
+
+    // A block that bailed out before its first instruction leaves it to the interpreter
+    block->code();
+    return executed > 0;
+}
+
+#else
+
+bool execute()
+{
+    // The JIT only targets x86-64
+    return false;
+}
+
+#endif
+
+}
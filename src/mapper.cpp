@@ -22,7 +22,12 @@
 #include <vector>
 
 #include "core.h"
+#include "aot.h"
+#include "cdl.h"
+#include "config.h"
 #include "cpu.h"
+#include "events.h"
+#include "perf.h"
 #include "ppu.h"
 
 namespace mapper
@@ -30,6 +35,8 @@ namespace mapper
 
 uint8_t *rom;
 uint32_t vromAddress;
+uint32_t prgBanks[4];
+uint32_t chrBanks[8];
 
 uint8_t type;
 uint8_t bankSelect, latch, shift;
@@ -39,6 +46,7 @@ bool irqEnable, irqReload;
 
 const vector<core::StateItem> stateItems =
 {
+    { prgBanks,      sizeof(prgBanks)      },
     { &bankSelect,   sizeof(bankSelect)    },
     { &latch,        sizeof(latch)         },
     { &shift,        sizeof(shift)         },
@@ -46,9 +54,33 @@ const vector<core::StateItem> stateItems =
     { &irqCount,     sizeof(irqCount)      },
     { &irqLatch,     sizeof(irqLatch)      },
     { &irqEnable,    sizeof(irqEnable)     },
-    { &irqReload,    sizeof(irqReload)     }
+    { &irqReload,    sizeof(irqReload)     },
+    { chrBanks,      sizeof(chrBanks)      }
 };
 
+void swapPrg(uint16_t address, uint32_t offset, uint32_t size)
+{
+    // Point the 8 KB windows covering an address range at a location in the ROM
+    for (uint32_t i = 0; i < size; i += 0x2000)
+    {
+        uint8_t window = (address + i - 0x8000) / 0x2000;
+        prgBanks[window] = offset + i;
+        cpu::mapPrg(0x8000 + window * 0x2000, &rom[prgBanks[window]], 0x2000);
+    }
+}
+
+void swapChr(uint16_t address, uint32_t offset, uint32_t size)
+{
+    // Copy a CHR bank into PPU memory, remembering where in the ROM each 1 KB window came from
+    memcpy(&ppu::memory[address], &rom[vromAddress + offset], size);
+    for (uint32_t i = 0; i < size; i += 0x400)
+    {
+        uint8_t window = (address + i) / 0x400;
+        chrBanks[window] = offset + i;
+        cdl::mapChr(window, chrBanks[window]);
+    }
+}
+
 bool load(FILE *romFile, uint8_t numBanks, uint8_t mapperType)
 {
     // Check if the mapper type is supported
@@ -72,15 +104,39 @@ bool load(FILE *romFile, uint8_t numBanks, uint8_t mapperType)
     fread(rom, 1, size, romFile);
     fclose(romFile);
 
+    // Start the code/data log for the ROM
+    cdl::reset(vromAddress, size - vromAddress);
+
     // Load the initial banks into system memory
     uint16_t lastSize = (type == 9) ? 0x6000 : 0x4000;
-    memcpy(&cpu::memory[0x8000], rom, 0x8000 - lastSize);
-    memcpy(&cpu::memory[0x10000 - lastSize], &rom[vromAddress - lastSize], lastSize);
-    memcpy(ppu::memory, &rom[vromAddress], 0x2000);
+    swapPrg(0x8000, 0, 0x8000 - lastSize);
+    swapPrg(0x10000 - lastSize, vromAddress - lastSize, lastSize);
+    swapChr(0, 0, 0x2000);
+
+    // Look for recompiled code built for this ROM
+    aot::load(rom, vromAddress);
 
     return true;
 }
 
+uint32_t prgOffset(uint16_t address)
+{
+    // Get the location in the ROM that an address in PRG space is mapped to
+    return prgBanks[(address - 0x8000) / 0x2000] + (address & 0x1FFF);
+}
+
+uint8_t prgRead(uint16_t address)
+{
+    // Read a byte of PRG ROM through the current banks
+    return rom[prgOffset(address)];
+}
+
+uint32_t chrOffset(uint16_t address)
+{
+    // Get the location in the CHR ROM that an address in the pattern tables is mapped to
+    return chrBanks[address / 0x400] + (address & 0x3FF);
+}
+
 void mmc1(uint16_t address, uint8_t value)
 {
     if (value & 0x80)
@@ -107,30 +163,30 @@ void mmc1(uint16_t address, uint8_t value)
         else if (address >= 0xA000 && address < 0xC000) // Swap VROM bank 0
         {
             if (bankSelect & 0x10) // 4 KB
-                memcpy(ppu::memory, &rom[vromAddress + 0x1000 * latch], 0x1000);
+                swapChr(0, 0x1000 * latch, 0x1000);
             else // 8 KB
-                memcpy(ppu::memory, &rom[vromAddress + 0x1000 * (latch & ~0x01)], 0x2000);
+                swapChr(0, 0x1000 * (latch & ~0x01), 0x2000);
         }
         else if (address >= 0xC000 && address < 0xE000) // Swap VROM bank 1
         {
             if (bankSelect & 0x10) // 4 KB
-                memcpy(&ppu::memory[0x1000], &rom[vromAddress + 0x1000 * latch], 0x1000);
+                swapChr(0x1000, 0x1000 * latch, 0x1000);
         }
         else // Swap ROM banks
         {
             if (!(bankSelect & 0x08)) // 32 KB
             {
-                memcpy(&cpu::memory[0x8000], &rom[0x4000 * (latch & ~0x01)], 0x8000);
+                swapPrg(0x8000, 0x4000 * (latch & ~0x01), 0x8000);
             }
             else if (bankSelect & 0x04) // 16 KB, bank 1 fixed
             {
-                memcpy(&cpu::memory[0x8000], &rom[0x4000 * latch], 0x4000);
-                memcpy(&cpu::memory[0xC000], &rom[vromAddress - 0x4000], 0x4000);
+                swapPrg(0x8000, 0x4000 * latch, 0x4000);
+                swapPrg(0xC000, vromAddress - 0x4000, 0x4000);
             }
             else // 16 KB, bank 0 fixed
             {
-                memcpy(&cpu::memory[0xC000], &rom[0x4000 * latch], 0x4000);
-                memcpy(&cpu::memory[0x8000], rom, 0x4000);
+                swapPrg(0xC000, 0x4000 * latch, 0x4000);
+                swapPrg(0x8000, 0, 0x4000);
             }
         }
 
@@ -143,14 +199,14 @@ void unrom(uint16_t address, uint8_t value)
 {
     // Swap the first 16 KB ROM bank
     if (address >= 0x8000)
-        memcpy(&cpu::memory[0x8000], &rom[0x4000 * value], 0x4000);
+        swapPrg(0x8000, 0x4000 * value, 0x4000);
 }
 
 void cnrom(uint16_t address, uint8_t value)
 {
     // Swap the 8 KB VROM bank
     if (address >= 0x8000)
-        memcpy(ppu::memory, &rom[vromAddress + 0x2000 * (value & 0x03)], 0x2000);
+        swapChr(0, 0x2000 * (value & 0x03), 0x2000);
 }
 
 void mmc3(uint16_t address, uint8_t value)
@@ -160,28 +216,26 @@ void mmc3(uint16_t address, uint8_t value)
         if (address % 2 == 0) // Select banks
         {
             bankSelect = value;
-            memcpy(&cpu::memory[(value & 0x40) ? 0x8000 : 0xC000], &rom[vromAddress - 0x4000], 0x2000);
+            swapPrg((value & 0x40) ? 0x8000 : 0xC000, vromAddress - 0x4000, 0x2000);
         }
         else // Swap banks
         {
             uint8_t bank = bankSelect & 0x07;
             if (bank < 2) // 2 KB VROM banks
             {
-                memcpy(&ppu::memory[((bankSelect & 0x80) ? 0x1000 : 0) + 0x800 * bank],
-                       &rom[vromAddress + 0x400 * (value & ~0x01)], 0x800);
+                swapChr(((bankSelect & 0x80) ? 0x1000 : 0) + 0x800 * bank, 0x400 * (value & ~0x01), 0x800);
             }
             else if (bank >= 2 && bank < 6) // 1 KB VROM banks
             {
-                memcpy(&ppu::memory[((bankSelect & 0x80) ? 0 : 0x1000) + 0x400 * (bank - 2)],
-                       &rom[vromAddress + 0x400 * value], 0x400);
+                swapChr(((bankSelect & 0x80) ? 0 : 0x1000) + 0x400 * (bank - 2), 0x400 * value, 0x400);
             }
             else if (bank == 6) // Swappable/fixed 8 KB ROM bank
             {
-                memcpy(&cpu::memory[(bankSelect & 0x40) ? 0xC000 : 0x8000], &rom[0x2000 * value], 0x2000);
+                swapPrg((bankSelect & 0x40) ? 0xC000 : 0x8000, 0x2000 * value, 0x2000);
             }
             else // Swappable 8 KB ROM bank
             {
-                memcpy(&cpu::memory[0xA000], &rom[0x2000 * value], 0x2000);
+                swapPrg(0xA000, 0x2000 * value, 0x2000);
             }
         }
     }
@@ -202,7 +256,10 @@ void mmc3(uint16_t address, uint8_t value)
     }
     else // IRQ toggle
     {
+        // Disabling IRQs also acknowledges a pending one
         irqEnable = (address % 2 == 1);
+        if (!irqEnable)
+            cpu::acknowledgeIrq(cpu::IRQ_MMC3);
     }
 }
 
@@ -211,7 +268,7 @@ void axrom(uint16_t address, uint8_t value)
     // Swap the 32 KB ROM bank and select a nametable for 1-screen mirroring
     if (address >= 0x8000)
     {
-        memcpy(&cpu::memory[0x8000], &rom[0x8000 * (value & 0x07)], 0x8000);
+        swapPrg(0x8000, 0x8000 * (value & 0x07), 0x8000);
         ppu::mirrorMode = (value & 0x10) ? 1 : 0;
     }
 }
@@ -220,7 +277,7 @@ void mmc2(uint16_t address, uint8_t value)
 {
     if (address >= 0xA000 && address < 0xB000) // Swap first 8 KB ROM bank
     {
-        memcpy(&cpu::memory[0x8000], &rom[0x2000 * value], 0x2000);
+        swapPrg(0x8000, 0x2000 * value, 0x2000);
     }
     else if (address < 0xF000) // Select VROM banks
     {
@@ -241,24 +298,23 @@ void map15(uint16_t address, uint8_t value)
         switch (address & 0x03)
         {
             case 0: // Swap the 32 KB bank (if bit 0 is set, acts like 16 KB mode)
-                memcpy(&cpu::memory[0x8000], &rom[0x4000 * bank], 0x4000);
-                memcpy(&cpu::memory[0xC000], &rom[0x4000 * (bank | 0x01)], 0x4000);
+                swapPrg(0x8000, 0x4000 * bank, 0x4000);
+                swapPrg(0xC000, 0x4000 * (bank | 0x01), 0x4000);
                 break;
 
             case 1: // Swap the first 16 KB bank and fix the last bank to the last of a 128 KB block
-                memcpy(&cpu::memory[0x8000], &rom[0x4000 * bank], 0x4000);
-                memcpy(&cpu::memory[0xC000], &rom[0x4000 * (bank | 0x07)], 0x4000);
+                swapPrg(0x8000, 0x4000 * bank, 0x4000);
+                swapPrg(0xC000, 0x4000 * (bank | 0x07), 0x4000);
                 break;
 
             case 2: // Swap a single 8 KB bank and mirror it
-                memcpy(&cpu::memory[0x8000], &rom[0x4000 * bank + ((value & 0x80) ? 0x2000 : 0)], 0x2000);
-                for (int i = 0; i < 3; i++)
-                    memcpy(&cpu::memory[0xA000 + i * 0x2000], &cpu::memory[0x8000], 0x2000);
+                for (int i = 0; i < 4; i++)
+                    swapPrg(0x8000 + i * 0x2000, 0x4000 * bank + ((value & 0x80) ? 0x2000 : 0), 0x2000);
                 break;
 
             case 3: // Swap a single 16 KB bank and mirror it
-                memcpy(&cpu::memory[0x8000], &rom[0x4000 * bank], 0x4000);
-                memcpy(&cpu::memory[0xC000], &cpu::memory[0x8000], 0x4000);
+                swapPrg(0x8000, 0x4000 * bank, 0x4000);
+                swapPrg(0xC000, 0x4000 * bank, 0x4000);
                 break;
         }
 
@@ -269,6 +325,14 @@ void map15(uint16_t address, uint8_t value)
 
 void registerWrite(uint16_t address, uint8_t value)
 {
+    // Note the write on the bus event timeline
+    if (config::busEvents)
+        events::record(address, value);
+
+    // Charge the bank switching to the mapper when sampling performance counters
+    uint8_t phase = perf::phase;
+    perf::phase = perf::PHASE_MAPPER;
+
     switch (type)
     {
         case  1:  mmc1(address, value); break;
@@ -279,6 +343,8 @@ void registerWrite(uint16_t address, uint8_t value)
         case  9:  mmc2(address, value); break;
         case 15: map15(address, value); break;
     }
+
+    perf::phase = phase;
 }
 
 void mmc3Counter()
@@ -291,7 +357,7 @@ void mmc3Counter()
     {
         // Trigger an IRQ if they're enabled
         if (irqEnable && !irqReload)
-            cpu::interrupts[2] = true;
+            cpu::assertIrq(cpu::IRQ_MMC3);
 
         irqCount = irqLatch;
         irqReload = false;
@@ -308,9 +374,9 @@ void mmc2SetLatch(uint8_t latch, bool value)
         return;
 
     if (latch == 0)
-        memcpy(ppu::memory, &rom[vromAddress + 0x1000 * mmc2VromBanks[value]], 0x1000);
+        swapChr(0, 0x1000 * mmc2VromBanks[value], 0x1000);
     else
-        memcpy(&ppu::memory[0x1000], &rom[vromAddress + 0x1000 * mmc2VromBanks[2 + value]], 0x1000);
+        swapChr(0x1000, 0x1000 * mmc2VromBanks[2 + value], 0x1000);
 }
 
 void saveState(FILE *state)
@@ -323,6 +389,12 @@ void loadState(FILE *state)
 {
     for (unsigned int i = 0; i < stateItems.size(); i++)
         fread(stateItems[i].pointer, 1, stateItems[i].size, state);
+
+    // Restore the PRG bank mapping and the CHR windows of the code/data log
+    for (int i = 0; i < 4; i++)
+        cpu::mapPrg(0x8000 + i * 0x2000, &rom[prgBanks[i]], 0x2000);
+    for (int i = 0; i < 8; i++)
+        cdl::mapChr(i, chrBanks[i]);
 }
 
 }
@@ -25,8 +25,17 @@
 namespace mapper
 {
 
+inline uint8_t headerType(const uint8_t *header)
+{
+    // Combine the mapper number from the upper nibbles of the flags bytes in an iNES header
+    return (header[7] & 0xF0) | (header[6] >> 4);
+}
+
 bool load(FILE *romFile, uint8_t numBanks, uint8_t mapperType);
 void registerWrite(uint16_t address, uint8_t value);
+uint32_t prgOffset(uint16_t address);
+uint8_t prgRead(uint16_t address);
+uint32_t chrOffset(uint16_t address);
 
 void mmc3Counter();
 void mmc2SetLatch(uint8_t latch, bool value);
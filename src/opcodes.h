@@ -0,0 +1,327 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPCODES_H
+#define OPCODES_H
+
+#include <cstdint>
+
+namespace cpu
+{
+
+enum Mode
+{
+    IMP, ACC, IMM, ZPG, ZPX, ZPY, ABS, ABX, ABY, IND, IZX, IZY, REL
+};
+
+enum Operation
+{
+    ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRK, BVC, BVS, CLC,
+    CLD, CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX, INY, JMP,
+    JSR, LDA, LDX, LDY, LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL, ROR, RTI,
+    RTS, SBC, SEC, SED, SEI, STA, STX, STY, TAX, TAY, TSX, TXA, TXS, TYA,
+    AHX, ALR, ANC, ARR, AXS, DCP, ISC, LAS, LAX, RLA, RRA, SAX, SHX, SHY,
+    SLO, SRE, STP, TAS, XAA // Unofficial
+};
+
+enum Access
+{
+    OTHER, READ, WRITE, RMW
+};
+
+typedef struct
+{
+    const char *mnemonic;
+    Operation operation;
+    Mode mode;
+    uint8_t cycles;
+    bool pageCycle; // Extra cycle on a page cross
+    Access access;
+} Opcode;
+
+// The opcode table, which generates the instruction handlers and drives the disassembler
+constexpr Opcode opcodes[0x100] =
+{
+    { "BRK", BRK, IMP, 7, false, OTHER }, // 0x00
+    { "ORA", ORA, IZX, 6, false, READ  }, // 0x01
+    { "STP", STP, IMP, 0, false, OTHER }, // 0x02
+    { "SLO", SLO, IZX, 8, false, RMW   }, // 0x03
+    { "NOP", NOP, ZPG, 3, false, READ  }, // 0x04
+    { "ORA", ORA, ZPG, 3, false, READ  }, // 0x05
+    { "ASL", ASL, ZPG, 5, false, RMW   }, // 0x06
+    { "SLO", SLO, ZPG, 5, false, RMW   }, // 0x07
+    { "PHP", PHP, IMP, 3, false, OTHER }, // 0x08
+    { "ORA", ORA, IMM, 2, false, READ  }, // 0x09
+    { "ASL", ASL, ACC, 2, false, OTHER }, // 0x0A
+    { "ANC", ANC, IMM, 2, false, READ  }, // 0x0B
+    { "NOP", NOP, ABS, 4, false, READ  }, // 0x0C
+    { "ORA", ORA, ABS, 4, false, READ  }, // 0x0D
+    { "ASL", ASL, ABS, 6, false, RMW   }, // 0x0E
+    { "SLO", SLO, ABS, 6, false, RMW   }, // 0x0F
+    { "BPL", BPL, REL, 2, false, OTHER }, // 0x10
+    { "ORA", ORA, IZY, 5, true,  READ  }, // 0x11
+    { "STP", STP, IMP, 0, false, OTHER }, // 0x12
+    { "SLO", SLO, IZY, 8, false, RMW   }, // 0x13
+    { "NOP", NOP, ZPX, 4, false, READ  }, // 0x14
+    { "ORA", ORA, ZPX, 4, false, READ  }, // 0x15
+    { "ASL", ASL, ZPX, 6, false, RMW   }, // 0x16
+    { "SLO", SLO, ZPX, 6, false, RMW   }, // 0x17
+    { "CLC", CLC, IMP, 2, false, OTHER }, // 0x18
+    { "ORA", ORA, ABY, 4, true,  READ  }, // 0x19
+    { "NOP", NOP, IMP, 2, false, OTHER }, // 0x1A
+    { "SLO", SLO, ABY, 7, false, RMW   }, // 0x1B
+    { "NOP", NOP, ABX, 4, true,  READ  }, // 0x1C
+    { "ORA", ORA, ABX, 4, true,  READ  }, // 0x1D
+    { "ASL", ASL, ABX, 7, false, RMW   }, // 0x1E
+    { "SLO", SLO, ABX, 7, false, RMW   }, // 0x1F
+    { "JSR", JSR, ABS, 6, false, OTHER }, // 0x20
+    { "AND", AND, IZX, 6, false, READ  }, // 0x21
+    { "STP", STP, IMP, 0, false, OTHER }, // 0x22
+    { "RLA", RLA, IZX, 8, false, RMW   }, // 0x23
+    { "BIT", BIT, ZPG, 3, false, READ  }, // 0x24
+    { "AND", AND, ZPG, 3, false, READ  }, // 0x25
+    { "ROL", ROL, ZPG, 5, false, RMW   }, // 0x26
+    { "RLA", RLA, ZPG, 5, false, RMW   }, // 0x27
+    { "PLP", PLP, IMP, 4, false, OTHER }, // 0x28
+    { "AND", AND, IMM, 2, false, READ  }, // 0x29
+    { "ROL", ROL, ACC, 2, false, OTHER }, // 0x2A
+    { "ANC", ANC, IMM, 2, false, READ  }, // 0x2B
+    { "BIT", BIT, ABS, 4, false, READ  }, // 0x2C
+    { "AND", AND, ABS, 4, false, READ  }, // 0x2D
+    { "ROL", ROL, ABS, 6, false, RMW   }, // 0x2E
+    { "RLA", RLA, ABS, 6, false, RMW   }, // 0x2F
+    { "BMI", BMI, REL, 2, false, OTHER }, // 0x30
+    { "AND", AND, IZY, 5, true,  READ  }, // 0x31
+    { "STP", STP, IMP, 0, false, OTHER }, // 0x32
+    { "RLA", RLA, IZY, 8, false, RMW   }, // 0x33
+    { "NOP", NOP, ZPX, 4, false, READ  }, // 0x34
+    { "AND", AND, ZPX, 4, false, READ  }, // 0x35
+    { "ROL", ROL, ZPX, 6, false, RMW   }, // 0x36
+    { "RLA", RLA, ZPX, 6, false, RMW   }, // 0x37
+    { "SEC", SEC, IMP, 2, false, OTHER }, // 0x38
+    { "AND", AND, ABY, 4, true,  READ  }, // 0x39
+    { "NOP", NOP, IMP, 2, false, OTHER }, // 0x3A
+    { "RLA", RLA, ABY, 7, false, RMW   }, // 0x3B
+    { "NOP", NOP, ABX, 4, true,  READ  }, // 0x3C
+    { "AND", AND, ABX, 4, true,  READ  }, // 0x3D
+    { "ROL", ROL, ABX, 7, false, RMW   }, // 0x3E
+    { "RLA", RLA, ABX, 7, false, RMW   }, // 0x3F
+    { "RTI", RTI, IMP, 6, false, OTHER }, // 0x40
+    { "EOR", EOR, IZX, 6, false, READ  }, // 0x41
+    { "STP", STP, IMP, 0, false, OTHER }, // 0x42
+    { "SRE", SRE, IZX, 8, false, RMW   }, // 0x43
+    { "NOP", NOP, ZPG, 3, false, READ  }, // 0x44
+    { "EOR", EOR, ZPG, 3, false, READ  }, // 0x45
+    { "LSR", LSR, ZPG, 5, false, RMW   }, // 0x46
+    { "SRE", SRE, ZPG, 5, false, RMW   }, // 0x47
+    { "PHA", PHA, IMP, 3, false, OTHER }, // 0x48
+    { "EOR", EOR, IMM, 2, false, READ  }, // 0x49
+    { "LSR", LSR, ACC, 2, false, OTHER }, // 0x4A
+    { "ALR", ALR, IMM, 2, false, READ  }, // 0x4B
+    { "JMP", JMP, ABS, 3, false, OTHER }, // 0x4C
+    { "EOR", EOR, ABS, 4, false, READ  }, // 0x4D
+    { "LSR", LSR, ABS, 6, false, RMW   }, // 0x4E
+    { "SRE", SRE, ABS, 6, false, RMW   }, // 0x4F
+    { "BVC", BVC, REL, 2, false, OTHER }, // 0x50
+    { "EOR", EOR, IZY, 5, true,  READ  }, // 0x51
+    { "STP", STP, IMP, 0, false, OTHER }, // 0x52
+    { "SRE", SRE, IZY, 8, false, RMW   }, // 0x53
+    { "NOP", NOP, ZPX, 4, false, READ  }, // 0x54
+    { "EOR", EOR, ZPX, 4, false, READ  }, // 0x55
+    { "LSR", LSR, ZPX, 6, false, RMW   }, // 0x56
+    { "SRE", SRE, ZPX, 6, false, RMW   }, // 0x57
+    { "CLI", CLI, IMP, 2, false, OTHER }, // 0x58
+    { "EOR", EOR, ABY, 4, true,  READ  }, // 0x59
+    { "NOP", NOP, IMP, 2, false, OTHER }, // 0x5A
+    { "SRE", SRE, ABY, 7, false, RMW   }, // 0x5B
+    { "NOP", NOP, ABX, 4, true,  READ  }, // 0x5C
+    { "EOR", EOR, ABX, 4, true,  READ  }, // 0x5D
+    { "LSR", LSR, ABX, 7, false, RMW   }, // 0x5E
+    { "SRE", SRE, ABX, 7, false, RMW   }, // 0x5F
+    { "RTS", RTS, IMP, 6, false, OTHER }, // 0x60
+    { "ADC", ADC, IZX, 6, false, READ  }, // 0x61
+    { "STP", STP, IMP, 0, false, OTHER }, // 0x62
+    { "RRA", RRA, IZX, 8, false, RMW   }, // 0x63
+    { "NOP", NOP, ZPG, 3, false, READ  }, // 0x64
+    { "ADC", ADC, ZPG, 3, false, READ  }, // 0x65
+    { "ROR", ROR, ZPG, 5, false, RMW   }, // 0x66
+    { "RRA", RRA, ZPG, 5, false, RMW   }, // 0x67
+    { "PLA", PLA, IMP, 4, false, OTHER }, // 0x68
+    { "ADC", ADC, IMM, 2, false, READ  }, // 0x69
+    { "ROR", ROR, ACC, 2, false, OTHER }, // 0x6A
+    { "ARR", ARR, IMM, 2, false, READ  }, // 0x6B
+    { "JMP", JMP, IND, 5, false, OTHER }, // 0x6C
+    { "ADC", ADC, ABS, 4, false, READ  }, // 0x6D
+    { "ROR", ROR, ABS, 6, false, RMW   }, // 0x6E
+    { "RRA", RRA, ABS, 6, false, RMW   }, // 0x6F
+    { "BVS", BVS, REL, 2, false, OTHER }, // 0x70
+    { "ADC", ADC, IZY, 5, true,  READ  }, // 0x71
+    { "STP", STP, IMP, 0, false, OTHER }, // 0x72
+    { "RRA", RRA, IZY, 8, false, RMW   }, // 0x73
+    { "NOP", NOP, ZPX, 4, false, READ  }, // 0x74
+    { "ADC", ADC, ZPX, 4, false, READ  }, // 0x75
+    { "ROR", ROR, ZPX, 6, false, RMW   }, // 0x76
+    { "RRA", RRA, ZPX, 6, false, RMW   }, // 0x77
+    { "SEI", SEI, IMP, 2, false, OTHER }, // 0x78
+    { "ADC", ADC, ABY, 4, true,  READ  }, // 0x79
+    { "NOP", NOP, IMP, 2, false, OTHER }, // 0x7A
+    { "RRA", RRA, ABY, 7, false, RMW   }, // 0x7B
+    { "NOP", NOP, ABX, 4, true,  READ  }, // 0x7C
+    { "ADC", ADC, ABX, 4, true,  READ  }, // 0x7D
+    { "ROR", ROR, ABX, 7, false, RMW   }, // 0x7E
+    { "RRA", RRA, ABX, 7, false, RMW   }, // 0x7F
+    { "NOP", NOP, IMM, 2, false, READ  }, // 0x80
+    { "STA", STA, IZX, 6, false, WRITE }, // 0x81
+    { "NOP", NOP, IMM, 2, false, READ  }, // 0x82
+    { "SAX", SAX, IZX, 6, false, WRITE }, // 0x83
+    { "STY", STY, ZPG, 3, false, WRITE }, // 0x84
+    { "STA", STA, ZPG, 3, false, WRITE }, // 0x85
+    { "STX", STX, ZPG, 3, false, WRITE }, // 0x86
+    { "SAX", SAX, ZPG, 3, false, WRITE }, // 0x87
+    { "DEY", DEY, IMP, 2, false, OTHER }, // 0x88
+    { "NOP", NOP, IMM, 2, false, READ  }, // 0x89
+    { "TXA", TXA, IMP, 2, false, OTHER }, // 0x8A
+    { "XAA", XAA, IMM, 2, false, READ  }, // 0x8B
+    { "STY", STY, ABS, 4, false, WRITE }, // 0x8C
+    { "STA", STA, ABS, 4, false, WRITE }, // 0x8D
+    { "STX", STX, ABS, 4, false, WRITE }, // 0x8E
+    { "SAX", SAX, ABS, 4, false, WRITE }, // 0x8F
+    { "BCC", BCC, REL, 2, false, OTHER }, // 0x90
+    { "STA", STA, IZY, 6, false, WRITE }, // 0x91
+    { "STP", STP, IMP, 0, false, OTHER }, // 0x92
+    { "AHX", AHX, IZY, 6, false, WRITE }, // 0x93
+    { "STY", STY, ZPX, 4, false, WRITE }, // 0x94
+    { "STA", STA, ZPX, 4, false, WRITE }, // 0x95
+    { "STX", STX, ZPY, 4, false, WRITE }, // 0x96
+    { "SAX", SAX, ZPY, 4, false, WRITE }, // 0x97
+    { "TYA", TYA, IMP, 2, false, OTHER }, // 0x98
+    { "STA", STA, ABY, 5, false, WRITE }, // 0x99
+    { "TXS", TXS, IMP, 2, false, OTHER }, // 0x9A
+    { "TAS", TAS, ABY, 5, false, WRITE }, // 0x9B
+    { "SHY", SHY, ABX, 5, false, WRITE }, // 0x9C
+    { "STA", STA, ABX, 5, false, WRITE }, // 0x9D
+    { "SHX", SHX, ABY, 5, false, WRITE }, // 0x9E
+    { "AHX", AHX, ABY, 5, false, WRITE }, // 0x9F
+    { "LDY", LDY, IMM, 2, false, READ  }, // 0xA0
+    { "LDA", LDA, IZX, 6, false, READ  }, // 0xA1
+    { "LDX", LDX, IMM, 2, false, READ  }, // 0xA2
+    { "LAX", LAX, IZX, 6, false, READ  }, // 0xA3
+    { "LDY", LDY, ZPG, 3, false, READ  }, // 0xA4
+    { "LDA", LDA, ZPG, 3, false, READ  }, // 0xA5
+    { "LDX", LDX, ZPG, 3, false, READ  }, // 0xA6
+    { "LAX", LAX, ZPG, 3, false, READ  }, // 0xA7
+    { "TAY", TAY, IMP, 2, false, OTHER }, // 0xA8
+    { "LDA", LDA, IMM, 2, false, READ  }, // 0xA9
+    { "TAX", TAX, IMP, 2, false, OTHER }, // 0xAA
+    { "LAX", LAX, IMM, 2, false, READ  }, // 0xAB
+    { "LDY", LDY, ABS, 4, false, READ  }, // 0xAC
+    { "LDA", LDA, ABS, 4, false, READ  }, // 0xAD
+    { "LDX", LDX, ABS, 4, false, READ  }, // 0xAE
+    { "LAX", LAX, ABS, 4, false, READ  }, // 0xAF
+    { "BCS", BCS, REL, 2, false, OTHER }, // 0xB0
+    { "LDA", LDA, IZY, 5, true,  READ  }, // 0xB1
+    { "STP", STP, IMP, 0, false, OTHER }, // 0xB2
+    { "LAX", LAX, IZY, 5, true,  READ  }, // 0xB3
+    { "LDY", LDY, ZPX, 4, false, READ  }, // 0xB4
+    { "LDA", LDA, ZPX, 4, false, READ  }, // 0xB5
+    { "LDX", LDX, ZPY, 4, false, READ  }, // 0xB6
+    { "LAX", LAX, ZPY, 4, false, READ  }, // 0xB7
+    { "CLV", CLV, IMP, 2, false, OTHER }, // 0xB8
+    { "LDA", LDA, ABY, 4, true,  READ  }, // 0xB9
+    { "TSX", TSX, IMP, 2, false, OTHER }, // 0xBA
+    { "LAS", LAS, ABY, 4, true,  READ  }, // 0xBB
+    { "LDY", LDY, ABX, 4, true,  READ  }, // 0xBC
+    { "LDA", LDA, ABX, 4, true,  READ  }, // 0xBD
+    { "LDX", LDX, ABY, 4, true,  READ  }, // 0xBE
+    { "LAX", LAX, ABY, 4, true,  READ  }, // 0xBF
+    { "CPY", CPY, IMM, 2, false, READ  }, // 0xC0
+    { "CMP", CMP, IZX, 6, false, READ  }, // 0xC1
+    { "NOP", NOP, IMM, 2, false, READ  }, // 0xC2
+    { "DCP", DCP, IZX, 8, false, RMW   }, // 0xC3
+    { "CPY", CPY, ZPG, 3, false, READ  }, // 0xC4
+    { "CMP", CMP, ZPG, 3, false, READ  }, // 0xC5
+    { "DEC", DEC, ZPG, 5, false, RMW   }, // 0xC6
+    { "DCP", DCP, ZPG, 5, false, RMW   }, // 0xC7
+    { "INY", INY, IMP, 2, false, OTHER }, // 0xC8
+    { "CMP", CMP, IMM, 2, false, READ  }, // 0xC9
+    { "DEX", DEX, IMP, 2, false, OTHER }, // 0xCA
+    { "AXS", AXS, IMM, 2, false, READ  }, // 0xCB
+    { "CPY", CPY, ABS, 4, false, READ  }, // 0xCC
+    { "CMP", CMP, ABS, 4, false, READ  }, // 0xCD
+    { "DEC", DEC, ABS, 6, false, RMW   }, // 0xCE
+    { "DCP", DCP, ABS, 6, false, RMW   }, // 0xCF
+    { "BNE", BNE, REL, 2, false, OTHER }, // 0xD0
+    { "CMP", CMP, IZY, 5, true,  READ  }, // 0xD1
+    { "STP", STP, IMP, 0, false, OTHER }, // 0xD2
+    { "DCP", DCP, IZY, 8, false, RMW   }, // 0xD3
+    { "NOP", NOP, ZPX, 4, false, READ  }, // 0xD4
+    { "CMP", CMP, ZPX, 4, false, READ  }, // 0xD5
+    { "DEC", DEC, ZPX, 6, false, RMW   }, // 0xD6
+    { "DCP", DCP, ZPX, 6, false, RMW   }, // 0xD7
+    { "CLD", CLD, IMP, 2, false, OTHER }, // 0xD8
+    { "CMP", CMP, ABY, 4, true,  READ  }, // 0xD9
+    { "NOP", NOP, IMP, 2, false, OTHER }, // 0xDA
+    { "DCP", DCP, ABY, 7, false, RMW   }, // 0xDB
+    { "NOP", NOP, ABX, 4, true,  READ  }, // 0xDC
+    { "CMP", CMP, ABX, 4, true,  READ  }, // 0xDD
+    { "DEC", DEC, ABX, 7, false, RMW   }, // 0xDE
+    { "DCP", DCP, ABX, 7, false, RMW   }, // 0xDF
+    { "CPX", CPX, IMM, 2, false, READ  }, // 0xE0
+    { "SBC", SBC, IZX, 6, false, READ  }, // 0xE1
+    { "NOP", NOP, IMM, 2, false, READ  }, // 0xE2
+    { "ISC", ISC, IZX, 8, false, RMW   }, // 0xE3
+    { "CPX", CPX, ZPG, 3, false, READ  }, // 0xE4
+    { "SBC", SBC, ZPG, 3, false, READ  }, // 0xE5
+    { "INC", INC, ZPG, 5, false, RMW   }, // 0xE6
+    { "ISC", ISC, ZPG, 5, false, RMW   }, // 0xE7
+    { "INX", INX, IMP, 2, false, OTHER }, // 0xE8
+    { "SBC", SBC, IMM, 2, false, READ  }, // 0xE9
+    { "NOP", NOP, IMP, 2, false, OTHER }, // 0xEA
+    { "SBC", SBC, IMM, 2, false, READ  }, // 0xEB
+    { "CPX", CPX, ABS, 4, false, READ  }, // 0xEC
+    { "SBC", SBC, ABS, 4, false, READ  }, // 0xED
+    { "INC", INC, ABS, 6, false, RMW   }, // 0xEE
+    { "ISC", ISC, ABS, 6, false, RMW   }, // 0xEF
+    { "BEQ", BEQ, REL, 2, false, OTHER }, // 0xF0
+    { "SBC", SBC, IZY, 5, true,  READ  }, // 0xF1
+    { "STP", STP, IMP, 0, false, OTHER }, // 0xF2
+    { "ISC", ISC, IZY, 8, false, RMW   }, // 0xF3
+    { "NOP", NOP, ZPX, 4, false, READ  }, // 0xF4
+    { "SBC", SBC, ZPX, 4, false, READ  }, // 0xF5
+    { "INC", INC, ZPX, 6, false, RMW   }, // 0xF6
+    { "ISC", ISC, ZPX, 6, false, RMW   }, // 0xF7
+    { "SED", SED, IMP, 2, false, OTHER }, // 0xF8
+    { "SBC", SBC, ABY, 4, true,  READ  }, // 0xF9
+    { "NOP", NOP, IMP, 2, false, OTHER }, // 0xFA
+    { "ISC", ISC, ABY, 7, false, RMW   }, // 0xFB
+    { "NOP", NOP, ABX, 4, true,  READ  }, // 0xFC
+    { "SBC", SBC, ABX, 4, true,  READ  }, // 0xFD
+    { "INC", INC, ABX, 7, false, RMW   }, // 0xFE
+    { "ISC", ISC, ABX, 7, false, RMW   }  // 0xFF
+};
+
+constexpr uint8_t length(Mode mode)
+{
+    // Get the size of an instruction in bytes from its addressing mode
+    return (mode == IMP || mode == ACC) ? 1 : (mode == ABS || mode == ABX || mode == ABY || mode == IND) ? 3 : 2;
+}
+
+}
+
+#endif // OPCODES_H
@@ -0,0 +1,127 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+
+#include "pacer.h"
+
+using namespace std;
+
+namespace pacer
+{
+
+// One NTSC frame is 89341.5 PPU dots at 5369318.18 Hz, or about 60.0988 Hz
+const chrono::nanoseconds framePeriod(16639263);
+
+// Time left before a deadline that is spun away instead of slept, to absorb oversleep
+const chrono::nanoseconds spinTime(1000000);
+
+// How far behind emulation can fall before the schedule is restarted instead of caught up
+const chrono::nanoseconds maxLag(framePeriod * 4);
+
+chrono::steady_clock::time_point deadline;
+Stats stats;
+
+uint32_t sampleRate = 44100;
+int64_t samplesProduced, sampleRemainder;
+atomic<int64_t> samplesConsumed;
+
+void reset()
+{
+    // Clear the statistics and start a new schedule on the next frame
+    memset(&stats, 0, sizeof(stats));
+    samplesProduced = sampleRemainder = samplesConsumed = 0;
+}
+
+void limitFrame()
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+    // Start a new schedule on the first frame, or after a stall that can't be caught up
+    if (stats.frames++ == 0 || now - deadline > maxLag)
+    {
+        if (stats.frames > 1)
+            stats.resyncs++;
+        deadline = now;
+        return;
+    }
+
+    // Schedule against an absolute deadline so that oversleeping doesn't accumulate
+    deadline += framePeriod;
+    if (now >= deadline)
+    {
+        stats.missed++;
+        return;
+    }
+
+    // Sleep until shortly before the deadline, then spin for the rest
+    if (deadline - now > spinTime)
+        usleep(chrono::duration_cast<chrono::microseconds>(deadline - now - spinTime).count());
+    while ((now = chrono::steady_clock::now()) < deadline);
+
+    // Record how late the wakeup was
+    stats.lastJitter = chrono::duration_cast<chrono::nanoseconds>(now - deadline).count();
+    stats.totalJitter += stats.lastJitter;
+    if (stats.lastJitter > stats.maxJitter)
+        stats.maxJitter = stats.lastJitter;
+}
+
+void setSampleRate(uint32_t rate)
+{
+    sampleRate = rate;
+}
+
+void consumeSamples(uint32_t count)
+{
+    // Advance the audio clock; this is called from the audio thread as samples are played
+    samplesConsumed += count;
+}
+
+void syncAudio()
+{
+    // Count the emulated time of the finished frame in samples, carrying the fractional part
+    // (a frame is 89341.5 PPU dots, and the PPU runs at 472500000 / 88 Hz)
+    sampleRemainder += (int64_t)sampleRate * 178683 * 88;
+    samplesProduced += sampleRemainder / 945000000;
+    sampleRemainder %= 945000000;
+    stats.frames++;
+
+    // Keep emulation ahead of the audio clock by two frames' worth of samples
+    int64_t targetFill = sampleRate / 30;
+    if (samplesProduced - samplesConsumed <= targetFill)
+        return;
+
+    // Block until the audio thread has consumed enough samples, giving up if audio has stopped
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (samplesProduced - samplesConsumed > targetFill)
+    {
+        if (chrono::steady_clock::now() - start > maxLag)
+        {
+            stats.resyncs++;
+            samplesProduced = samplesConsumed + targetFill;
+            return;
+        }
+        usleep(500);
+    }
+}
+
+}
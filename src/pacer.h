@@ -0,0 +1,49 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PACER_H
+#define PACER_H
+
+#include <cstdint>
+
+namespace pacer
+{
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t missed;
+    uint32_t resyncs;
+    int64_t lastJitter;
+    int64_t maxJitter;
+    int64_t totalJitter;
+} Stats;
+
+extern Stats stats;
+
+void reset();
+void limitFrame();
+
+void setSampleRate(uint32_t rate);
+void consumeSamples(uint32_t count);
+void syncAudio();
+
+}
+
+#endif // PACER_H
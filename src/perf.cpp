@@ -0,0 +1,220 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <csignal>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "perf.h"
+
+namespace perf
+{
+
+const char *phaseNames[PHASE_COUNT] = { "other", "CPU", "PPU", "APU", "mapper", "handoff" };
+const char *counterNames[COUNTER_COUNT] = { "instructions", "cycles", "branch misses", "cache misses", "task ns" };
+
+// The part of the core that's running, which samples are charged to
+volatile uint8_t phase;
+
+bool counting;
+bool available[COUNTER_COUNT];
+vector<Frame> frames;
+
+#ifdef __linux__
+
+// The counters are read together as a group, led by the thread's CPU clock
+int leader = -1;
+int members[COUNTER_COUNT];
+int slots[COUNTER_COUNT]; // Where each counter is in a group read, or -1 if it couldn't be opened
+
+uint64_t lastSample[COUNTER_COUNT], frameStart[COUNTER_COUNT];
+Frame current;
+
+// Set while a frame is being finished, so that a sample arriving then is left for the next one
+volatile sig_atomic_t busy;
+
+int openCounter(uint32_t type, uint64_t config, int group, uint32_t period)
+{
+    // Count in user space on the calling thread, on whichever CPU it runs
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    // Only the leader samples, and it starts disabled until everything is set up
+    if (group == -1)
+    {
+        attr.disabled = 1;
+        attr.sample_period = period;
+        attr.wakeup_events = 1;
+    }
+
+    return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+bool readGroup(uint64_t *values)
+{
+    // Read every counter in the group at once, leaving the ones that couldn't be opened at 0
+    uint64_t buffer[1 + COUNTER_COUNT];
+    if (read(leader, buffer, sizeof(buffer)) < (ssize_t)sizeof(uint64_t))
+        return false;
+    for (int i = 0; i < COUNTER_COUNT; i++)
+        values[i] = (slots[i] >= 0) ? buffer[1 + slots[i]] : 0;
+    return true;
+}
+
+void sample(int, siginfo_t*, void*)
+{
+    int error = errno;
+
+    // Charge the counts since the last sample to the phase that was running when the sampling period ran out
+    uint64_t values[COUNTER_COUNT];
+    if (!busy && readGroup(values))
+    {
+        uint8_t charged = (phase < PHASE_COUNT) ? phase : (uint8_t)PHASE_OTHER;
+        for (int i = 0; i < COUNTER_COUNT; i++)
+        {
+            current.phases[charged][i] += values[i] - lastSample[i];
+            lastSample[i] = values[i];
+        }
+    }
+
+    // Re-arm the leader for the next period, leaving the handler itself uncounted
+    ioctl(leader, PERF_EVENT_IOC_REFRESH, 1);
+    errno = error;
+}
+
+bool start(uint32_t period)
+{
+    // Lead the group with the thread's CPU clock, which is always there even when the hardware counters aren't
+    leader = openCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1, period);
+    if (leader < 0)
+    {
+        printf("Failed to open performance counters: %s\n", strerror(errno));
+        return false;
+    }
+
+    memset(slots, -1, sizeof(slots));
+    memset(members, -1, sizeof(members));
+    slots[COUNT_TASK_CLOCK] = 0;
+    available[COUNT_TASK_CLOCK] = true;
+
+    // Add the hardware counters that the CPU and kernel provide
+    const uint64_t configs[] = { PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+                                 PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES };
+    int size = 1;
+    for (int i = 0; i < COUNT_TASK_CLOCK; i++)
+    {
+        members[i] = openCounter(PERF_TYPE_HARDWARE, configs[i], leader, 0);
+        available[i] = (members[i] >= 0);
+        if (available[i])
+            slots[i] = size++;
+    }
+
+    // Deliver the leader's overflows as signals to this thread
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = sample;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigaction(SIGIO, &action, nullptr);
+
+    f_owner_ex owner = { F_OWNER_TID, (pid_t)syscall(SYS_gettid) };
+    fcntl(leader, F_SETFL, O_ASYNC);
+    fcntl(leader, F_SETSIG, SIGIO);
+    fcntl(leader, F_SETOWN_EX, &owner);
+
+    // Start counting from zero
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    memset(&current, 0, sizeof(current));
+    memset(lastSample, 0, sizeof(lastSample));
+    memset(frameStart, 0, sizeof(frameStart));
+    frames.clear();
+    busy = 0;
+    counting = true;
+    ioctl(leader, PERF_EVENT_IOC_REFRESH, 1);
+    return true;
+}
+
+void endFrame()
+{
+    // Record the exact counts over the frame along with the samples charged to each phase
+    busy = 1;
+    uint64_t values[COUNTER_COUNT];
+    if (readGroup(values))
+    {
+        for (int i = 0; i < COUNTER_COUNT; i++)
+        {
+            current.totals[i] = values[i] - frameStart[i];
+            frameStart[i] = values[i];
+        }
+    }
+    frames.push_back(current);
+    memset(&current, 0, sizeof(current));
+    busy = 0;
+}
+
+void stop()
+{
+    // Stop sampling and close the counters
+    if (!counting)
+        return;
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    signal(SIGIO, SIG_DFL);
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        if (members[i] >= 0)
+            close(members[i]);
+    }
+    close(leader);
+    leader = -1;
+    counting = false;
+}
+
+#else
+
+bool start(uint32_t)
+{
+    printf("Performance counters are only supported on Linux\n");
+    return false;
+}
+
+void endFrame()
+{
+}
+
+void stop()
+{
+}
+
+#endif
+
+}
@@ -0,0 +1,72 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+namespace perf
+{
+
+enum Phase
+{
+    PHASE_OTHER = 0,
+    PHASE_CPU,
+    PHASE_PPU,
+    PHASE_APU,
+    PHASE_MAPPER,
+    PHASE_HANDOFF,
+    PHASE_COUNT
+};
+
+enum Counter
+{
+    COUNT_INSTRUCTIONS = 0,
+    COUNT_CYCLES,
+    COUNT_BRANCH_MISSES,
+    COUNT_CACHE_MISSES,
+    COUNT_TASK_CLOCK, // Nanoseconds of thread CPU time, which also paces the sampling
+    COUNTER_COUNT
+};
+
+typedef struct
+{
+    uint64_t totals[COUNTER_COUNT]; // Exact counts over the frame
+    uint64_t phases[PHASE_COUNT][COUNTER_COUNT]; // Sampled counts for each phase, which add up to about the totals
+} Frame;
+
+extern const char *phaseNames[PHASE_COUNT];
+extern const char *counterNames[COUNTER_COUNT];
+
+extern volatile uint8_t phase;
+extern bool counting;
+extern bool available[COUNTER_COUNT];
+extern vector<Frame> frames;
+
+bool start(uint32_t period);
+void endFrame();
+void stop();
+
+}
+
+#endif // PERF_H
@@ -19,24 +19,28 @@
 
 #include "core.h"
 
-#include <chrono>
 #include <cstdio>
 #include <cstring>
-#include <unistd.h>
 #include <vector>
 
+#include "cdl.h"
 #include "config.h"
 #include "cpu.h"
 #include "mapper.h"
 #include "mutex.h"
+#include "perf.h"
+#include "timing.h"
+#include "ppu.h"
 
 namespace ppu
 {
 
-chrono::steady_clock::time_point timer;
 uint32_t framebuffer[256 * 240];
 uint32_t displayBuffer[256 * 240];
+uint8_t indexBuffer[256 * 240];
+uint8_t displayIndices[256 * 240];
 void *displayMutex;
+bool frameFinished;
 
 uint8_t memory[0x4000];
 uint8_t sprMemory[0x100];
@@ -71,7 +75,7 @@ const vector<core::StateItem> stateItems =
     { &writeToggle, sizeof(writeToggle) }
 };
 
-const uint32_t palette[] =
+const uint32_t palette[0x40] =
 {
     0x757575FF, 0x271B8FFF, 0x0000ABFF, 0x47009FFF,
     0x8F0077FF, 0xAB0013FF, 0xA70000FF, 0x7F0B00FF,
@@ -98,6 +102,7 @@ void reset()
         memset(stateItems[i].pointer, 0, stateItems[i].size);
 
     displayMutex = mutex::create();
+    frameFinished = false;
 }
 
 uint16_t memoryMirror(uint16_t address)
@@ -160,6 +165,10 @@ void fetchPixels()
     else // Bottom right
         upperBits = (upperBits & 0xC0) >> 4;
 
+    // Log the row of the tile as rendered
+    cdl::logChr(tile + yOffset % 8, cdl::CHR_RENDERED);
+    cdl::logChr(tile + yOffset % 8 + 8, cdl::CHR_RENDERED);
+
     for (int i = 0; i < 8; i++)
     {
         // Get the lower 2 bits of the palette index from the pattern table
@@ -210,11 +219,17 @@ void runCycle()
 
                 // Draw a pixel
                 if (type % 2 == 1)
-                    *pixel = palette[memory[0x3F00 | color]];
+                {
+                    indexBuffer[scanline * 256 + x] = memory[0x3F00 | color];
+                    *pixel = palette[indexBuffer[scanline * 256 + x]];
+                }
             }
         }
         else if (scanlineDot >= 257 && scanlineDot <= 320 && (mask & 0x10)) // Sprite drawing
         {
+            // Bring sprite memory up to date if a DMA transfer is in progress
+            cpu::syncDma();
+
             uint8_t *sprite = &sprMemory[(scanlineDot - 257) * 4];
             uint8_t height = (control & 0x20) ? 16 : 8;
             uint8_t y = scanline;
@@ -241,6 +256,10 @@ void runCycle()
                         spriteY = 7 - (spriteY % 8);
                     }
 
+                    // Log the row of the sprite as rendered
+                    cdl::logChr(tile + spriteY, cdl::CHR_RENDERED);
+                    cdl::logChr(tile + spriteY + 8, cdl::CHR_RENDERED);
+
                     // Draw a sprite line on the next scanline
                     y++;
                     for (int i = 0; i < 8; i++)
@@ -249,7 +268,8 @@ void runCycle()
                         uint8_t lowerBits = memory[tile + spriteY] & (0x80 >> i) ? 0x01 : 0x00;
                         lowerBits |= memory[tile + spriteY + 8] & (0x80 >> i) ? 0x02 : 0x00;
 
-                        if ((xOffset >= 8 || (mask & 0x04)) && xOffset < 256 && lowerBits != 0)
+                        // Sprites on the last visible line would be drawn below the bottom of the buffers, so skip them
+                        if ((xOffset >= 8 || (mask & 0x04)) && xOffset < 256 && y < 240 && lowerBits != 0)
                         {
                             uint32_t *pixel = &framebuffer[y * 256 + xOffset];
                             uint8_t type = *pixel;
@@ -257,7 +277,8 @@ void runCycle()
                             if (type == 0xFF)
                             {
                                 // Draw a pixel
-                                *pixel = palette[memory[0x3F10 | upperBits | lowerBits]];
+                                indexBuffer[y * 256 + xOffset] = memory[0x3F10 | upperBits | lowerBits];
+                                *pixel = palette[indexBuffer[y * 256 + xOffset]];
 
                                 // Mark opaque pixels
                                 (*pixel)--;
@@ -309,7 +330,7 @@ void runCycle()
         // Trigger an NMI if enabled
         status |= 0x80;
         if (control & 0x80)
-            cpu::interrupts[0] = true;
+            cpu::assertNmi();
     }
     else if (scanline == 261) // Pre-render line
     {
@@ -342,29 +363,50 @@ void runCycle()
 
         if (scanline == 262) // End of frame
         {
-            // Copy the finished frame to the display
+            // Copy the finished frame to the display, timing it and charging performance counter samples to it as the
+            // handoff
+            perf::phase = perf::PHASE_HANDOFF;
+            uint64_t start = timing::now();
             mutex::lock(displayMutex);
             memcpy(displayBuffer, framebuffer, sizeof(displayBuffer));
+            memcpy(displayIndices, indexBuffer, sizeof(displayIndices));
             mutex::unlock(displayMutex);
 
             // Clear the framebuffer
             for (int i = 0; i < 256 * 240; i++)
                 framebuffer[i] = palette[memory[0x3F00]];
+            memset(indexBuffer, memory[0x3F00], sizeof(indexBuffer));
+            timing::record(timing::STAGE_HANDOFF, timing::now() - start);
+            perf::phase = perf::PHASE_PPU;
 
-            // Limit the FPS to 60 if enabled
-            if (config::frameLimiter)
-            {
-                chrono::duration<double> elapsed = chrono::steady_clock::now() - timer;
-                if (elapsed.count() < 1.0f / 60)
-                    usleep((1.0f / 60 - elapsed.count()) * 1000000);
-                timer = chrono::steady_clock::now();
-            }
-
+            frameFinished = true;
             scanline = 0;
         }
     }
 }
 
+uint32_t nextEvent()
+{
+    // Count the dots until the next one that can raise an interrupt or finish the frame, where 0 is the dot run in the
+    // current global cycle; MMC3 counter clocks are counted for every mapper, since they only end blocks early
+    uint32_t position = scanline * 341 + scanlineDot;
+    uint32_t events[] = { 241 * 341 + 1, 261 * 341 + 340 };
+    uint32_t distance = events[1] - position;
+    if (position <= events[0])
+        distance = events[0] - position;
+
+    if (mask & 0x18)
+    {
+        uint32_t line = (scanlineDot <= 260) ? scanline : scanline + 1;
+        if (line >= 240 && line < 261)
+            line = 261;
+        if (line < 262 && line * 341 + 260 - position < distance)
+            distance = line * 341 + 260 - position;
+    }
+
+    return distance;
+}
+
 uint8_t registerRead(uint16_t address)
 {
     uint8_t value = 0;
@@ -386,6 +428,8 @@ uint8_t registerRead(uint16_t address)
 
         case 0x2007: // PPUDATA
             // Read from PPU memory, buffering non-palette reads
+            if (memoryMirror(ppuAddress) < 0x2000)
+                cdl::logChr(memoryMirror(ppuAddress), cdl::CHR_READ);
             value = (ppuAddress < 0x3F00) ? readBuffer : memory[memoryMirror(ppuAddress)];
             readBuffer = memory[memoryMirror(ppuAddress)];
             ppuAddress += (control & 0x04) ? 32 : 1;
@@ -447,14 +491,15 @@ void registerWrite(uint16_t address, uint8_t value)
             memory[memoryMirror(ppuAddress)] = (ppuAddress < 0x3F00) ? value : value % 0x40;
             ppuAddress += (control & 0x04) ? 32 : 1;
             break;
-
-        case 0x4014: // OAMDMA
-            // DMA transfer to sprite memory
-            memcpy(sprMemory, &cpu::memory[value * 0x100], 0x100);
-            break;
     }
 }
 
+void dmaWrite(uint8_t index, uint8_t value)
+{
+    // Write a byte of a DMA transfer to sprite memory
+    sprMemory[index] = value;
+}
+
 void saveState(FILE *state)
 {
     for (unsigned int i = 0; i < stateItems.size(); i++)
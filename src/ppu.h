@@ -24,16 +24,23 @@ namespace ppu
 {
 
 extern uint32_t displayBuffer[256 * 240];
+extern uint8_t displayIndices[256 * 240];
+extern const uint32_t palette[0x40];
 extern void *displayMutex;
+extern bool frameFinished;
 
 extern uint8_t memory[0x4000];
 extern uint8_t mirrorMode;
+extern uint8_t status;
+extern uint16_t scanline, scanlineDot;
 
 void reset();
 void runCycle();
+uint32_t nextEvent();
 
 uint8_t registerRead(uint16_t address);
 void registerWrite(uint16_t address, uint8_t value);
+void dmaWrite(uint8_t index, uint8_t value);
 
 void saveState(FILE *state);
 void loadState(FILE *state);
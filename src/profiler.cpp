@@ -0,0 +1,198 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+#include "core.h"
+#include "cpu.h"
+#include "mapper.h"
+#include "profiler.h"
+
+namespace profiler
+{
+
+typedef struct
+{
+    uint32_t parent;
+    uint32_t location;
+    uint64_t cycles;
+} Node;
+
+typedef struct
+{
+    uint32_t caller;
+    uint8_t stackPointer;
+} Frame;
+
+// The most calls that are tracked before deeper ones are counted in their caller
+const size_t maxDepth = 256;
+
+// Cycles by location, where a location is a RAM address or an offset into PRG ROM past 0x8000
+vector<uint64_t> counts;
+vector<uint16_t> addresses;
+uint32_t current;
+
+// The tree of call stacks, with the top level at node 0
+vector<Node> nodes;
+unordered_map<uint64_t, uint32_t> children;
+vector<Frame> frames;
+uint32_t node;
+
+uint32_t location(uint16_t address)
+{
+    // Qualify a ROM address by the bank mapped to it
+    return (address < 0x8000) ? address : (0x8000 + mapper::prgOffset(address));
+}
+
+string name(uint32_t location)
+{
+    // Name a location by its address, with the 8 KB ROM bank in front
+    char name[16];
+    if (location < 0x8000)
+        sprintf(name, "$%04X", location);
+    else
+        sprintf(name, "%02X:$%04X", (location - 0x8000) / 0x2000, addresses[location]);
+    return name;
+}
+
+void reset()
+{
+    // Clear the profile
+    counts.clear();
+    addresses.clear();
+    current = 0;
+    nodes.assign(1, { 0, 0, 0 });
+    children.clear();
+    frames.clear();
+    node = 0;
+}
+
+void charge(uint16_t cycles)
+{
+    // Charge cycles to the instruction that started at the last boundary and to its call stack
+    if (current < counts.size())
+        counts[current] += cycles;
+    nodes[node].cycles += cycles;
+}
+
+void count(uint16_t cycles)
+{
+    // Charge the cycles since the last instruction boundary
+    charge(cycles);
+
+    // Start timing the instruction at the new boundary, noting its address the first time it's seen
+    current = location(cpu::programCounter);
+    if (current >= counts.size())
+    {
+        counts.resize(current + 1);
+        addresses.resize(current + 1);
+    }
+    if (!counts[current])
+        addresses[current] = cpu::programCounter;
+}
+
+void call(uint16_t address)
+{
+    if (frames.size() == maxDepth)
+        return;
+
+    // Enter a subroutine or an interrupt handler as a child of the current stack, once its return address is pushed
+    uint32_t callee = location(address);
+    uint64_t key = ((uint64_t)node << 32) | callee;
+    unordered_map<uint64_t, uint32_t>::iterator child = children.find(key);
+    frames.push_back({ node, cpu::stackPointer });
+    if (child != children.end())
+    {
+        node = child->second;
+        return;
+    }
+
+    nodes.push_back({ node, callee, 0 });
+    node = nodes.size() - 1;
+    children[key] = node;
+    if (callee >= addresses.size())
+    {
+        counts.resize(callee + 1);
+        addresses.resize(callee + 1);
+    }
+    addresses[callee] = address;
+}
+
+void ret()
+{
+    // Leave every call whose return address has been pulled, which also unwinds stacks that were reset or faked
+    while (!frames.empty() && frames.back().stackPointer < cpu::stackPointer)
+    {
+        node = frames.back().caller;
+        frames.pop_back();
+    }
+}
+
+void write(string romName)
+{
+    uint64_t total = 0;
+    for (size_t i = 0; i < counts.size(); i++)
+        total += counts[i];
+    if (total == 0)
+        return;
+
+    // Write the flat profile, with the locations that took the most cycles first
+    vector<uint32_t> order;
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        if (counts[i])
+            order.push_back(i);
+    }
+    sort(order.begin(), order.end(), [](uint32_t a, uint32_t b) { return counts[a] > counts[b]; });
+
+    FILE *file = fopen((romName + ".profile").c_str(), "w");
+    if (!file)
+        return;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        // Disassemble the instruction if its bank is still mapped
+        uint16_t address = addresses[order[i]];
+        string instruction = (location(address) == order[i]) ? cpu::disassemble(address) : "";
+        fprintf(file, "%12llu %6.2f%%  %-10s %s\n", (unsigned long long)counts[order[i]], counts[order[i]] * 100.0 / total,
+            name(order[i]).c_str(), instruction.c_str());
+    }
+    fclose(file);
+
+    // Write the call stacks in the folded format that flame graph tools read
+    file = fopen((romName + ".folded").c_str(), "w");
+    if (!file)
+        return;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (!nodes[i].cycles)
+            continue;
+        string stack;
+        for (uint32_t j = i; j != 0; j = nodes[j].parent)
+            stack = ";" + name(nodes[j].location) + stack;
+        fprintf(file, "main%s %llu\n", stack.c_str(), (unsigned long long)nodes[i].cycles);
+    }
+    fclose(file);
+
+    printf("Wrote the profile to %s.profile and %s.folded\n", romName.c_str(), romName.c_str());
+}
+
+}
@@ -0,0 +1,521 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// A static recompiler that translates the reachable code in a ROM's PRG banks to C++
+// Usage: noies-recompiler rom.nes output.cpp
+// Adding the output to the build and enabling the "recompiled" setting lets NoiES run the
+// routines whenever the program counter and the PRG bank mapped there match one of them
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "../core.h"
+#include "../aot.h"
+#include "../mapper.h"
+#include "../opcodes.h"
+
+using namespace cpu;
+
+namespace recompiler
+{
+
+// The most instructions in a block
+const uint8_t maxLength = 64;
+
+uint8_t *prg;
+uint32_t prgSize;
+uint8_t mapperType;
+uint16_t lastSize;
+
+// Instructions are identified by their address and where they are in the ROM
+set<uint64_t> visited, guessed, leaders, functions;
+vector<pair<uint64_t, bool>> queue;
+
+uint64_t location(uint16_t address, uint32_t offset)
+{
+    return ((uint64_t)offset << 16) | address;
+}
+
+uint32_t powerOnOffset(uint16_t address)
+{
+    // Get the location of an address in the banks that the core maps at power-on
+    if (address >= 0x10000 - lastSize)
+        return prgSize - lastSize + (address - (0x10000 - lastSize));
+    return address - 0x8000;
+}
+
+bool decodable(uint16_t address, uint32_t offset)
+{
+    // Only translate instructions that lie entirely in one 8 KB window of the ROM
+    uint8_t length = cpu::length(opcodes[prg[offset]].mode);
+    return (address & 0x1FFF) + length <= 0x2000 && offset + length <= prgSize;
+}
+
+uint16_t operandAt(uint32_t offset)
+{
+    // Read the operand of the instruction at a location in the ROM
+    switch (cpu::length(opcodes[prg[offset]].mode))
+    {
+        case 2:  return prg[offset + 1];
+        case 3:  return prg[offset + 1] | (prg[offset + 2] << 8);
+        default: return 0;
+    }
+}
+
+void target(uint16_t from, uint32_t fromOffset, uint16_t address, bool leader, bool function, bool guess)
+{
+    // Code can only run from PRG ROM
+    if (address < 0x8000)
+        return;
+
+    vector<uint32_t> offsets;
+    if ((address >> 13) == (from >> 13))
+    {
+        // Within a window, the target is in the same bank
+        offsets.push_back(fromOffset - (from & 0x1FFF) + (address & 0x1FFF));
+    }
+    else
+    {
+        // In another window, the target is in the bank mapped at power-on or any bank the mapper can switch in;
+        // code reached through a guessed bank doesn't guess again, so that guesses into data don't cascade
+        offsets.push_back(powerOnOffset(address));
+        if (mapperType != 0 && !guess)
+        {
+            for (uint32_t bank = 0; bank < prgSize; bank += 0x2000)
+                offsets.push_back(bank + (address & 0x1FFF));
+        }
+    }
+
+    // Queue the possible locations
+    for (unsigned int i = 0; i < offsets.size(); i++)
+    {
+        uint64_t key = location(address, offsets[i]);
+        if (leader)
+            leaders.insert(key);
+        if (function)
+            functions.insert(key);
+        queue.push_back(make_pair(key, guess || i > 0));
+    }
+}
+
+void trace()
+{
+    // Follow every path through the code that can be found statically
+    while (!queue.empty())
+    {
+        uint64_t key = queue.back().first;
+        bool guess = queue.back().second;
+        queue.pop_back();
+
+        // Trace an instruction again if it was only reached through a guess before
+        if (!visited.insert(key).second && (guess || !guessed.erase(key)))
+            continue;
+        if (guess)
+            guessed.insert(key);
+
+        uint16_t address = key;
+        uint32_t offset = key >> 16;
+        if (!decodable(address, offset))
+            continue;
+
+        const Opcode *opcode = &opcodes[prg[offset]];
+        uint16_t operand = operandAt(offset);
+        uint16_t next = address + cpu::length(opcode->mode);
+
+        // Treat unofficial opcodes in a guessed bank as a sign that it holds data
+        if (guess && opcode->operation >= AHX)
+            continue;
+
+        switch (opcode->operation)
+        {
+            case STP: case BRK: case RTS: case RTI:
+                // End the path; BRK continues at the IRQ vector, which is traced separately
+                break;
+
+            case JMP:
+                // Follow an absolute jump; indirect targets can't be known statically
+                if (opcode->mode == ABS)
+                    target(address, offset, operand, true, false, guess);
+                break;
+
+            case JSR:
+                // Follow a subroutine call, and continue where it returns to
+                target(address, offset, operand, true, true, guess);
+                target(address, offset, next, true, false, guess);
+                break;
+
+            default:
+                // Follow both paths of a branch, or continue to the next instruction
+                if (opcode->mode == REL)
+                {
+                    target(address, offset, next + (int8_t)operand, true, false, guess);
+                    target(address, offset, next, true, false, guess);
+                }
+                else
+                {
+                    target(address, offset, next, false, false, guess);
+                }
+                break;
+        }
+    }
+}
+
+bool safe(uint16_t first, uint16_t last, bool write)
+{
+    // Check that a range of addresses only maps to memory, or to ROM for reads
+    for (uint32_t page = first >> 8; page <= (uint32_t)(last >> 8); page++)
+    {
+        if ((page >= 0x20 && page <= 0x40) || (write && page >= 0x80))
+            return false;
+    }
+    return true;
+}
+
+string readExpression(Mode mode, uint16_t operand)
+{
+    // Build an expression that reads the value an instruction operates on
+    char text[64];
+    switch (mode)
+    {
+        case IMM: sprintf(text, "0x%02X", operand);                                   break;
+        case ZPG: sprintf(text, "cpu::memory[0x%02X]", operand);                      break;
+        case ZPX: sprintf(text, "cpu::memory[(uint8_t)(0x%02X + cpu::registerX)]", operand); break;
+        case ZPY: sprintf(text, "cpu::memory[(uint8_t)(0x%02X + cpu::registerY)]", operand); break;
+        default:
+            if (operand < 0x2000)
+                sprintf(text, "cpu::memory[0x%03X]", operand & 0x7FF);
+            else
+                sprintf(text, "cpu::memoryRead(0x%04X)", operand);
+            break;
+    }
+    return text;
+}
+
+string writeStatement(Mode mode, uint16_t operand, string value)
+{
+    // Build a statement that writes a value to an instruction's operand
+    char text[64];
+    switch (mode)
+    {
+        case ZPG: sprintf(text, "0x%02X", operand);                                 break;
+        case ZPX: sprintf(text, "(uint8_t)(0x%02X + cpu::registerX)", operand);     break;
+        case ZPY: sprintf(text, "(uint8_t)(0x%02X + cpu::registerY)", operand);     break;
+        default:  sprintf(text, "0x%04X", operand);                                 break;
+    }
+    return "cpu::memoryWrite(" + string(text) + ", " + value + ");";
+}
+
+string translate(const Opcode *opcode, uint16_t operand)
+{
+    // Translate an instruction with a fixed address to C++ (";" if it does nothing), or return nothing if it
+    // has to use its handler
+    Mode mode = opcode->mode;
+    if (mode != IMP && mode != ACC && mode != IMM && mode != ZPG && mode != ZPX && mode != ZPY && mode != ABS)
+        return "";
+
+    string read = readExpression(mode, operand);
+    switch (opcode->operation)
+    {
+        case LDA: return "cpu::accumulator = " + read + "; aot::setNZ(cpu::accumulator);";
+        case LDX: return "cpu::registerX = " + read + "; aot::setNZ(cpu::registerX);";
+        case LDY: return "cpu::registerY = " + read + "; aot::setNZ(cpu::registerY);";
+        case STA: return writeStatement(mode, operand, "cpu::accumulator");
+        case STX: return writeStatement(mode, operand, "cpu::registerX");
+        case STY: return writeStatement(mode, operand, "cpu::registerY");
+        case AND: return "cpu::accumulator &= " + read + "; aot::setNZ(cpu::accumulator);";
+        case ORA: return "cpu::accumulator |= " + read + "; aot::setNZ(cpu::accumulator);";
+        case EOR: return "cpu::accumulator ^= " + read + "; aot::setNZ(cpu::accumulator);";
+        case ADC: return "cpu::addCarry(" + read + ");";
+        case SBC: return "cpu::subtractCarry(" + read + ");";
+        case CMP: return "cpu::compare(cpu::accumulator, " + read + ");";
+        case CPX: return "cpu::compare(cpu::registerX, " + read + ");";
+        case CPY: return "cpu::compare(cpu::registerY, " + read + ");";
+        case BIT: return "aot::bit(" + read + ");";
+        case INC: return "{ uint8_t value = " + read + " + 1; aot::setNZ(value); " + writeStatement(mode, operand, "value") + " }";
+        case DEC: return "{ uint8_t value = " + read + " - 1; aot::setNZ(value); " + writeStatement(mode, operand, "value") + " }";
+        case INX: return "aot::setNZ(++cpu::registerX);";
+        case INY: return "aot::setNZ(++cpu::registerY);";
+        case DEX: return "aot::setNZ(--cpu::registerX);";
+        case DEY: return "aot::setNZ(--cpu::registerY);";
+        case TAX: return "cpu::registerX = cpu::accumulator; aot::setNZ(cpu::registerX);";
+        case TAY: return "cpu::registerY = cpu::accumulator; aot::setNZ(cpu::registerY);";
+        case TXA: return "cpu::accumulator = cpu::registerX; aot::setNZ(cpu::accumulator);";
+        case TYA: return "cpu::accumulator = cpu::registerY; aot::setNZ(cpu::accumulator);";
+        case TSX: return "cpu::registerX = cpu::stackPointer; aot::setNZ(cpu::registerX);";
+        case TXS: return "cpu::stackPointer = cpu::registerX;";
+        case CLC: return "cpu::flags &= ~0x01;";
+        case SEC: return "cpu::flags |= 0x01;";
+        case CLD: return "cpu::flags &= ~0x08;";
+        case SED: return "cpu::flags |= 0x08;";
+        case CLV: return "cpu::flags &= ~0x40;";
+        case NOP: return ";";
+
+        case ASL: case LSR: case ROL: case ROR:
+        {
+            string function = (opcode->operation == ASL) ? "aot::asl" : (opcode->operation == LSR) ? "aot::lsr" :
+                (opcode->operation == ROL) ? "aot::rol" : "aot::ror";
+            if (mode == ACC)
+                return "cpu::accumulator = " + function + "(cpu::accumulator);";
+            return "{ uint8_t value = " + function + "(" + read + "); " + writeStatement(mode, operand, "value") + " }";
+        }
+
+        default:
+            return "";
+    }
+}
+
+bool accessible(const Opcode *opcode, uint16_t operand)
+{
+    // Check that an instruction with a fixed address doesn't access a register handler
+    Access access = opcode->access;
+    if ((opcode->mode != ZPG && opcode->mode != ABS) || access == OTHER)
+        return true;
+    return safe(operand, operand, access == WRITE || access == RMW) && (access == WRITE || safe(operand, operand, false));
+}
+
+void exit(FILE *out, const char *indent, uint32_t cycles, int32_t address, uint32_t count)
+{
+    // Charge the cycles of the translated instructions and return to the interpreter
+    if (cycles > 0)
+        fprintf(out, "%scpu::targetCycles += %u;\n", indent, cycles);
+    if (address >= 0)
+        fprintf(out, "%scpu::programCounter = 0x%04X;\n", indent, address);
+    fprintf(out, "%sreturn %u;\n", indent, count);
+}
+
+bool block(FILE *out, uint16_t start, uint32_t startOffset)
+{
+    // Leave a block that would start with an instruction the routines can't run to the interpreter,
+    // starting another after it if possible
+    const Opcode *first = &opcodes[prg[startOffset]];
+    if (first->operation == STP)
+        return false;
+    if (!accessible(first, operandAt(startOffset)))
+    {
+        uint8_t length = cpu::length(first->mode);
+        if (((start + length) >> 13) == (start >> 13))
+            leaders.insert(location(start + length, startOffset + length));
+        return false;
+    }
+
+    // Write the routine for a basic block
+    if (functions.count(location(start, startOffset)))
+        fprintf(out, "// Function at $%04X\n", start);
+    fprintf(out, "int block%05X_%04X()\n{\n", startOffset, start);
+
+    uint16_t address = start;
+    uint32_t offset = startOffset;
+    uint32_t cycles = 0, count = 0;
+
+    while (true)
+    {
+        // Stay within a page and a window, keep the block short, and stop where another block starts
+        if (count == maxLength || (address >> 8) != (start >> 8) || !decodable(address, offset) ||
+            (count > 0 && leaders.count(location(address, offset))))
+            break;
+
+        const Opcode *opcode = &opcodes[prg[offset]];
+        uint8_t value = prg[offset];
+        uint16_t operand = operandAt(offset);
+        uint16_t next = address + cpu::length(opcode->mode);
+        Access access = opcode->access;
+        bool reads = (access == READ || access == RMW), writes = (access == WRITE || access == RMW);
+
+        // Leave jammed instructions to the interpreter
+        if (opcode->operation == STP)
+            break;
+
+        // End the block before an access with a fixed address that can reach a register handler
+        if (!accessible(opcode, operand))
+            break;
+
+        fprintf(out, "    // $%04X: %s\n", address, opcode->mnemonic);
+
+        // Return before an instruction that could run past the next PPU or APU event, so that interrupts are
+        // taken at the same boundary as in the interpreter; the first one always runs, as it would there too
+        if (count > 0)
+        {
+            fprintf(out, "    if (cpu::targetCycles + %u > aot::limit)\n    {\n",
+                cycles + opcode->cycles + ((opcode->mode == REL) ? 2 : 1));
+            exit(out, "        ", cycles, address, count);
+            fprintf(out, "    }\n");
+        }
+
+        // Handle the instructions that end a block
+        if (opcode->mode == REL)
+        {
+            const char *conditions[] = { "!(cpu::flags & 0x01)", "cpu::flags & 0x01", "cpu::zero()", "",
+                "cpu::negative()", "!cpu::zero()", "!cpu::negative()", "", "!(cpu::flags & 0x40)",
+                "cpu::flags & 0x40" };
+            uint16_t destination = next + (int8_t)operand;
+            uint8_t taken = 1 + (((destination ^ next) & 0xFF00) ? 1 : 0);
+            fprintf(out, "    if (%s)\n    {\n", conditions[opcode->operation - BCC]);
+            exit(out, "        ", cycles + opcode->cycles + taken, destination, count + 1);
+            fprintf(out, "    }\n");
+            exit(out, "    ", cycles + opcode->cycles, next, count + 1);
+            fprintf(out, "}\n\n");
+            return true;
+        }
+        if (opcode->operation == JMP && opcode->mode == ABS)
+        {
+            exit(out, "    ", cycles + opcode->cycles, operand, count + 1);
+            fprintf(out, "}\n\n");
+            return true;
+        }
+
+        string code = translate(opcode, operand);
+        if (code.empty())
+        {
+            // Check at runtime that an access with a variable address doesn't reach a register handler
+            char effective[64] = "";
+            switch (opcode->mode)
+            {
+                case ABX: sprintf(effective, "(uint16_t)(0x%04X + cpu::registerX)", operand); break;
+                case ABY: sprintf(effective, "(uint16_t)(0x%04X + cpu::registerY)", operand); break;
+                case IZX: sprintf(effective, "aot::indirectX(0x%02X)", operand);              break;
+                case IZY: sprintf(effective, "aot::indirectY(0x%02X)", operand);              break;
+                default:  break;
+            }
+            bool fixed = ((opcode->mode == ABX || opcode->mode == ABY) &&
+                safe(operand, operand + 0xFF, false) && (!writes || safe(operand, operand + 0xFF, true)));
+            if (effective[0] && access != OTHER && !fixed)
+            {
+                fprintf(out, "    if (!aot::direct(%s, %s)", effective, writes ? "true" : "false");
+                if (reads && writes)
+                    fprintf(out, " || !aot::direct(%s, false)", effective);
+                fprintf(out, ")\n    {\n");
+                exit(out, "        ", cycles, address, count);
+                fprintf(out, "    }\n");
+            }
+
+            // Run the instruction through its handler, which charges its own cycles
+            fprintf(out, "    cpu::programCounter = 0x%04X;\n", address);
+            fprintf(out, "    cpu::handlers[0x%02X](0x%04X);\n", value, operand);
+            count++;
+
+            // Return after an instruction that changes the program counter, or that can unmask a pending IRQ
+            if (opcode->operation == JSR || opcode->operation == JMP || opcode->operation == RTS ||
+                opcode->operation == RTI || opcode->operation == BRK || opcode->operation == CLI ||
+                opcode->operation == PLP)
+            {
+                exit(out, "    ", cycles, -1, count);
+                fprintf(out, "}\n\n");
+                return true;
+            }
+        }
+        else
+        {
+            if (code != ";")
+                fprintf(out, "    %s\n", code.c_str());
+            cycles += opcode->cycles;
+            count++;
+        }
+
+        address = next;
+        offset += cpu::length(opcode->mode);
+    }
+
+    // Continue in the interpreter, which can start another routine at the next instruction
+    exit(out, "    ", cycles, address, count);
+    fprintf(out, "}\n\n");
+    leaders.insert(location(address, offset));
+    return true;
+}
+
+}
+
+using namespace recompiler;
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printf("Usage: %s rom.nes output.cpp\n", argv[0]);
+        return 1;
+    }
+
+    // Read and check the ROM header
+    FILE *rom = fopen(argv[1], "rb");
+    uint8_t header[0x10];
+    if (!rom || fread(header, 1, 0x10, rom) != 0x10 || memcmp(header, "NES\x1A", 4) != 0)
+    {
+        printf("Invalid ROM file: %s\n", argv[1]);
+        return 1;
+    }
+
+    // Load the PRG ROM, skipping the trainer if there is one
+    if (header[6] & 0x04)
+        fseek(rom, 0x200, SEEK_CUR);
+    prgSize = header[4] * 0x4000;
+    mapperType = mapper::headerType(header);
+    lastSize = (mapperType == 9) ? 0x6000 : 0x4000;
+    prg = new uint8_t[prgSize];
+    if (prgSize == 0 || fread(prg, 1, prgSize, rom) != prgSize)
+    {
+        printf("Invalid ROM file: %s\n", argv[1]);
+        return 1;
+    }
+    fclose(rom);
+
+    // Trace the code reachable from the interrupt vectors
+    for (uint32_t address = 0xFFFA; address < 0x10000; address += 2)
+    {
+        uint32_t offset = powerOnOffset(address);
+        target(address, offset, prg[offset] | (prg[offset + 1] << 8), true, true, false);
+    }
+    trace();
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out)
+    {
+        printf("Failed to open %s\n", argv[2]);
+        return 1;
+    }
+
+    fprintf(out, "// Recompiled from %s by noies-recompiler\n\n", argv[1]);
+    fprintf(out, "#include \"aot.h\"\n\nnamespace\n{\n\n");
+
+    // Write a routine for each basic block, in ROM order; a block that is cut short adds a leader after
+    // itself, which the set iterator still reaches
+    vector<uint64_t> blocks;
+    for (set<uint64_t>::iterator i = leaders.begin(); i != leaders.end(); i++)
+    {
+        if (visited.count(*i) && decodable(*i, *i >> 16) && block(out, *i, *i >> 16))
+            blocks.push_back(*i);
+    }
+
+    // Write the table that registers the routines with the core
+    fprintf(out, "const aot::Routine routines[] =\n{\n");
+    for (unsigned int i = 0; i < blocks.size(); i++)
+    {
+        uint16_t address = blocks[i];
+        uint32_t offset = blocks[i] >> 16;
+        fprintf(out, "    { 0x%04X, 0x%05X, block%05X_%04X }%s\n", address, offset, offset, address,
+            (i + 1 < blocks.size()) ? "," : "");
+    }
+    fprintf(out, "};\n\n");
+    fprintf(out, "aot::Registration registration(0x%08X, routines, sizeof(routines) / sizeof(routines[0]));\n\n}\n",
+        aot::checksum(prg, prgSize));
+    fclose(out);
+
+    printf("Recompiled %u blocks from %u instructions\n", (unsigned int)blocks.size(), (unsigned int)visited.size());
+    return 0;
+}
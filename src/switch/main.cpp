@@ -23,6 +23,7 @@
 #include "../apu.h"
 #include "../config.h"
 #include "../mutex.h"
+#include "../pacer.h"
 
 bool paused;
 Thread coreThread, audioThread;
@@ -87,6 +88,7 @@ const vector<string> controlSubnames =
 const vector<string> settingNames =
 {
     "Frame Limiter",
+    "Audio Sync",
     "Disable Sprite Limit",
     "Screen Filtering",
     "Crop Overscan",
@@ -99,12 +101,14 @@ const vector<vector<string>> settingSubnames =
     { "Off", "On" },
     { "Off", "On" },
     { "Off", "On" },
+    { "Off", "On" },
     { "Pixel Perfect", "4:3", "16:9" }
 };
 
 const vector<u32*> settingValues =
 {
     &config::frameLimiter,
+    &config::audioSync,
     &config::disableSpriteLimit,
     &screenFiltering,
     &cropOverscan,
@@ -122,8 +126,18 @@ const vector<string> pauseNames =
 
 void runCore(void *args)
 {
+    pacer::reset();
+
     while (!paused)
-        core::runCycle();
+    {
+        core::runFrame();
+
+        // Pace emulation by the audio clock or the frame deadline, depending on settings
+        if (config::audioSync)
+            pacer::syncAudio();
+        else if (config::frameLimiter)
+            pacer::limitFrame();
+    }
 }
 
 void audioOutput(void *args)
@@ -141,6 +155,7 @@ void audioOutput(void *args)
             ((s16*)audioBuffer->buffer)[i * 2 + 1] = sample;
         }
         audoutAppendAudioOutBuffer(audioBuffer);
+        pacer::consumeSamples(1024);
     }
 }
 
@@ -176,6 +191,7 @@ void startCore()
     audoutStartAudioOut();
     setupAudioBuffer();
     setScreenLayout();
+    pacer::setSampleRate(48000);
     threadCreate(&coreThread, runCore, NULL, NULL, 0x8000, 0x30, 1);
     threadStart(&coreThread);
     threadCreate(&audioThread, audioOutput, NULL, NULL, 0x8000, 0x30, 0);
@@ -0,0 +1,155 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "timing.h"
+#include "mutex.h"
+
+namespace timing
+{
+
+const char *stageNames[STAGE_COUNT] = { "cpu", "ppu", "apu", "handoff", "present", "sleep" };
+
+// The number of recent frames that the statistics cover, about 10 seconds
+const uint32_t windowSize = 600;
+
+uint32_t countdown = sampleInterval;
+uint64_t sampledTicks[STAGE_HANDOFF];
+uint32_t sampledCount;
+
+// The cost of reading the clock, which every sampled time includes once
+double clockCost;
+
+// The time of each stage in the recent frames, in a ring per stage, along with the latest time of each
+uint32_t window[STAGE_COUNT][windowSize];
+uint32_t positions[STAGE_COUNT], counts[STAGE_COUNT];
+uint32_t latest[STAGE_COUNT];
+void *windowMutex;
+
+// When emulation of the current frame started
+uint64_t frameStart;
+
+void reset()
+{
+    // Clear the windows, keeping the mutex since the frontend may be using it
+    if (!windowMutex)
+        windowMutex = mutex::create();
+    mutex::lock(windowMutex);
+    memset(positions, 0, sizeof(positions));
+    memset(counts, 0, sizeof(counts));
+    mutex::unlock(windowMutex);
+
+    // Measure the cost of reading the clock back to back
+    uint64_t total = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        uint64_t start = ticks();
+        total += ticks() - start;
+    }
+    clockCost = total / 1000.0;
+
+    memset(sampledTicks, 0, sizeof(sampledTicks));
+    sampledCount = 0;
+    countdown = sampleInterval;
+    frameStart = now();
+}
+
+void record(Stage stage, uint64_t nanoseconds)
+{
+    // Add a frame's time for a stage to its window, replacing the oldest once it's full
+    mutex::lock(windowMutex);
+    latest[stage] = (nanoseconds < UINT32_MAX) ? nanoseconds : UINT32_MAX;
+    window[stage][positions[stage]] = latest[stage];
+    positions[stage] = (positions[stage] + 1) % windowSize;
+    if (counts[stage] < windowSize)
+        counts[stage]++;
+    mutex::unlock(windowMutex);
+}
+
+void startFrame()
+{
+    // Start timing the emulation of a frame
+    frameStart = now();
+}
+
+void endFrame()
+{
+    // Take the emulation time of the frame, less the handoff that was timed on its own
+    uint64_t time = now() - frameStart;
+    time = (time > latest[STAGE_HANDOFF]) ? time - latest[STAGE_HANDOFF] : 0;
+
+    // Split it by the sampled time of each component, less the cost of reading the clock for each sample
+    // Splitting a measured time instead of scaling up the samples keeps a single preempted sample from reading as a long frame
+    double sampled[STAGE_HANDOFF], total = 0;
+    for (int i = 0; i < STAGE_HANDOFF; i++)
+    {
+        sampled[i] = sampledTicks[i] - sampledCount * clockCost;
+        if (sampled[i] < 0)
+            sampled[i] = 0;
+        total += sampled[i];
+        sampledTicks[i] = 0;
+    }
+    for (int i = 0; i < STAGE_HANDOFF; i++)
+        record((Stage)i, (total > 0) ? time * sampled[i] / total : 0);
+    sampledCount = 0;
+}
+
+Summary summarize(Stage stage)
+{
+    // Copy the stage's window and find its percentiles
+    uint32_t sorted[windowSize];
+    mutex::lock(windowMutex);
+    uint32_t count = counts[stage];
+    memcpy(sorted, window[stage], count * sizeof(uint32_t));
+    mutex::unlock(windowMutex);
+
+    Summary summary = { 0, 0, 0 };
+    if (count == 0)
+        return summary;
+    std::sort(sorted, sorted + count);
+    summary.p50 = sorted[count / 2];
+    summary.p99 = sorted[count * 99 / 100];
+    summary.max = sorted[count - 1];
+    return summary;
+}
+
+void write(FILE *file)
+{
+    // Write the statistics of every stage as JSON, along with the window of times they were taken from, oldest first
+    fprintf(file, "{\n    \"sampleInterval\": %u,\n    \"stages\": {\n", sampleInterval);
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        Summary summary = summarize((Stage)i);
+        fprintf(file, "        \"%s\": { \"p50\": %u, \"p99\": %u, \"max\": %u, \"frames\": [",
+            stageNames[i], summary.p50, summary.p99, summary.max);
+
+        mutex::lock(windowMutex);
+        uint32_t start = (counts[i] < windowSize) ? 0 : positions[i];
+        for (uint32_t j = 0; j < counts[i]; j++)
+            fprintf(file, (j > 0) ? ", %u" : "%u", window[i][(start + j) % windowSize]);
+        mutex::unlock(windowMutex);
+
+        fprintf(file, "] }%s\n", (i < STAGE_COUNT - 1) ? "," : "");
+    }
+    fprintf(file, "    }\n}\n");
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace timing
+{
+
+enum Stage
+{
+    STAGE_CPU = 0,
+    STAGE_PPU,
+    STAGE_APU,
+    STAGE_HANDOFF, // Copying the finished frame to the display buffer
+    STAGE_PRESENT, // Uploading and drawing the frame in the frontend
+    STAGE_SLEEP, // Waiting on the frame limiter or the audio clock
+    STAGE_COUNT
+};
+
+typedef struct
+{
+    uint32_t p50, p99, max; // Nanoseconds per frame over the recent window
+} Summary;
+
+// One in this many global cycles is timed, and the emulation time of a frame is split between the CPU, PPU and APU
+// in proportion to the time sampled for each
+const uint32_t sampleInterval = 256;
+
+extern const char *stageNames[STAGE_COUNT];
+extern uint32_t countdown;
+extern uint64_t sampledTicks[STAGE_HANDOFF];
+extern uint32_t sampledCount;
+
+inline uint64_t ticks()
+{
+    // Read a fast clock for timing single cycles, in whatever unit it counts
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+inline uint64_t now()
+{
+    // Read the time in nanoseconds
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void reset();
+void record(Stage stage, uint64_t nanoseconds);
+void startFrame();
+void endFrame();
+
+Summary summarize(Stage stage);
+void write(FILE *file);
+
+}
+
+#endif // TIMING_H
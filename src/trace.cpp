@@ -0,0 +1,154 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "core.h"
+#include "cpu.h"
+#include "ppu.h"
+#include "trace.h"
+
+namespace trace
+{
+
+// The most recent instructions are kept, with older ones overwritten
+const uint32_t size = 0x10000;
+
+Record records[size];
+uint32_t position;
+bool wrapped;
+
+// When streaming, the ring is written out whenever it fills and at the end of every frame
+FILE *stream;
+
+uint64_t cycles;
+bool jammed;
+uint16_t jamAddress;
+
+void reset()
+{
+    // Clear the trace
+    position = 0;
+    wrapped = false;
+    cycles = 0;
+    jammed = false;
+}
+
+void record()
+{
+    // Leave out the repeats of a jammed instruction, so that the history leading up to it survives
+    if (jammed)
+    {
+        if (cpu::programCounter == jamAddress)
+            return;
+        jammed = false;
+    }
+
+    // Store the CPU state before the instruction at the current position in the ring
+    Record *record = &records[position];
+    record->cycle          = cycles;
+    record->programCounter = cpu::programCounter;
+    record->scanline       = ppu::scanline;
+    record->scanlineDot    = ppu::scanlineDot;
+    record->opcode         = cpu::memoryPeek(cpu::programCounter);
+    record->value          = cpu::memoryPeek(cpu::programCounter + 1);
+    record->high           = cpu::memoryPeek(cpu::programCounter + 2);
+    record->accumulator    = cpu::accumulator;
+    record->registerX      = cpu::registerX;
+    record->registerY      = cpu::registerY;
+    record->flags          = cpu::getFlags();
+    record->stackPointer   = cpu::stackPointer;
+
+    if (++position == size)
+    {
+        if (stream)
+        {
+            flush();
+            return;
+        }
+        position = 0;
+        wrapped = true;
+    }
+}
+
+void jam()
+{
+    // Dump the trace the first time the CPU halts somewhere, since nothing after it will run
+    if (jammed)
+        return;
+    jammed = true;
+    jamAddress = cpu::programCounter;
+    printf("CPU jammed at $%04X\n", jamAddress);
+    core::dumpTrace();
+}
+
+void dump(FILE *file)
+{
+    // Write the records from oldest to newest as text
+    uint32_t count = wrapped ? size : position;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Record *record = &records[(position - count + i + size) % size];
+        fprintf(file, "%12llu %3u,%3u  %04X  %-14s A:%02X X:%02X Y:%02X P:%02X SP:%02X\n",
+            (unsigned long long)record->cycle, record->scanline, record->scanlineDot, record->programCounter,
+            cpu::disassemble(record->programCounter, record->opcode, record->value, record->high).c_str(),
+            record->accumulator, record->registerX, record->registerY, record->flags, record->stackPointer);
+    }
+}
+
+void startStream(string filename)
+{
+    // Write every instruction to a file from now on, instead of only keeping the most recent ones
+    stopStream();
+    stream = fopen(filename.c_str(), "w");
+    if (!stream)
+        printf("Failed to open %s for streaming the trace\n", filename.c_str());
+}
+
+void stopStream()
+{
+    // Write out what's left in the ring and close the file
+    if (!stream)
+        return;
+    flush();
+    fclose(stream);
+    stream = nullptr;
+}
+
+bool streaming()
+{
+    return stream;
+}
+
+void flush()
+{
+    // Write the records in the ring to the stream and empty it
+    dump(stream);
+    position = 0;
+    wrapped = false;
+}
+
+void endFrame(uint32_t frame)
+{
+    // Mark the end of a frame in the stream, so that traces can be compared frame by frame
+    if (!stream)
+        return;
+    flush();
+    fprintf(stream, "-- end of frame %u\n", frame);
+}
+
+}
@@ -0,0 +1,58 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+using namespace std;
+
+namespace trace
+{
+
+typedef struct
+{
+    uint64_t cycle;
+    uint16_t programCounter;
+    uint16_t scanline, scanlineDot;
+    uint8_t opcode, value, high;
+    uint8_t accumulator, registerX, registerY;
+    uint8_t flags;
+    uint8_t stackPointer;
+} Record;
+
+extern uint64_t cycles;
+
+void reset();
+void record();
+void jam();
+void dump(FILE *file);
+
+void startStream(string filename);
+void stopStream();
+bool streaming();
+void flush();
+void endFrame(uint32_t frame);
+
+}
+
+#endif // TRACE_H
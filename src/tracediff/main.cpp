@@ -0,0 +1,193 @@
+/*
+    Copyright 2019 Hydr8gon
+
+    This file is part of NoiES.
+
+    NoiES is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NoiES is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NoiES. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Finds where two runs first diverge, from their streamed traces (trace = 2) or their checkpoints (checkpoints = 1)
+// Usage: noies-tracediff a.trace b.trace [context]
+// Frames are compared by digests that chain each frame to the ones before it, so a binary search over them finds
+// the first frame that differs; that frame is then scanned line by line and shown side by side with the other run
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace tracediff
+{
+
+typedef struct
+{
+    long offset;     // Where the frame starts in the file
+    uint64_t line;   // The number of lines before it
+    uint64_t digest; // A hash of every line up to the end of the frame
+} Frame;
+
+// Lines are cut to this width when shown side by side
+const int width = 76;
+
+bool isCheckpoints(FILE *file)
+{
+    // Checkpoint files hold one "frame N: hash" line per frame
+    char start[7] = {};
+    size_t count = fread(start, 1, 6, file);
+    rewind(file);
+    return count == 6 && strcmp(start, "frame ") == 0;
+}
+
+vector<Frame> index(FILE *file, uint64_t *total)
+{
+    // Split a file into frames at the end-of-frame markers, or at every line for checkpoints
+    bool checkpoints = isCheckpoints(file);
+    vector<Frame> frames;
+    Frame frame = { 0, 0, 1469598103934665603ULL };
+    uint64_t count = 0;
+
+    char *line = nullptr;
+    size_t capacity = 0;
+    ssize_t length;
+    while ((length = getline(&line, &capacity, file)) > 0)
+    {
+        for (ssize_t i = 0; i < length; i++)
+            frame.digest = (frame.digest ^ (uint8_t)line[i]) * 1099511628211ULL;
+        count++;
+
+        // Close the frame at its marker, and start the next one after it
+        if (checkpoints || strncmp(line, "-- ", 3) == 0)
+        {
+            frames.push_back(frame);
+            frame.offset = ftell(file);
+            frame.line = count;
+        }
+    }
+    free(line);
+
+    // Keep the lines after the last marker as a frame of their own, as they're what a crashed run leaves
+    if (frame.line < count)
+        frames.push_back(frame);
+    *total = count;
+    return frames;
+}
+
+vector<string> readLines(FILE *file, long offset, uint64_t count)
+{
+    // Read up to a number of lines from an offset in a file
+    vector<string> lines;
+    fseek(file, offset, SEEK_SET);
+    char *line = nullptr;
+    size_t capacity = 0;
+    ssize_t length;
+    while (lines.size() < count && (length = getline(&line, &capacity, file)) > 0)
+        lines.push_back(string(line, (line[length - 1] == '\n') ? length - 1 : length));
+    free(line);
+    return lines;
+}
+
+string column(const vector<string> &lines, size_t i)
+{
+    // Fit a line to its column, with a placeholder past the end of a run
+    string text = (i < lines.size()) ? lines[i] : "<end>";
+    if (text.size() > (size_t)width)
+        text = text.substr(0, width);
+    return text;
+}
+
+}
+
+using namespace tracediff;
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printf("Usage: %s a.trace b.trace [context]\n", argv[0]);
+        return 2;
+    }
+    int context = (argc > 3) ? atoi(argv[3]) : 8;
+
+    FILE *files[2];
+    for (int i = 0; i < 2; i++)
+    {
+        if (!(files[i] = fopen(argv[1 + i], "r")))
+        {
+            printf("Failed to open %s\n", argv[1 + i]);
+            return 2;
+        }
+    }
+
+    // Index both runs and binary search for the first frame whose chained digest differs
+    uint64_t totals[2];
+    vector<Frame> frames[2] = { index(files[0], &totals[0]), index(files[1], &totals[1]) };
+    size_t low = 0, high = min(frames[0].size(), frames[1].size());
+    while (low < high)
+    {
+        size_t middle = (low + high) / 2;
+        if (frames[0][middle].digest == frames[1][middle].digest)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low == frames[0].size() && low == frames[1].size())
+    {
+        printf("The runs match for all %u frames\n", (unsigned int)low);
+        return 0;
+    }
+
+    // Read the differing frame from both runs with some context around it, starting from the frame that holds
+    // the first line of context; since everything before the differing frame matches, the lines of the runs line up
+    uint64_t frameStart = (low < frames[0].size()) ? frames[0][low].line : totals[0];
+    uint64_t target = (frameStart > (uint64_t)context) ? frameStart - context : 0;
+    size_t first = low;
+    while (first > 0 && (first >= frames[0].size() || frames[0][first].line > target))
+        first--;
+    uint64_t base = (first < frames[0].size()) ? frames[0][first].line : 0;
+
+    vector<string> lines[2];
+    for (int i = 0; i < 2; i++)
+    {
+        uint64_t frameEnd = (low + 1 < frames[i].size()) ? frames[i][low + 1].line : totals[i];
+        if (first < frames[i].size())
+            lines[i] = readLines(files[i], frames[i][first].offset, frameEnd + context - base);
+        fclose(files[i]);
+    }
+
+    // Scan the frame line by line for the first difference
+    size_t diverge = frameStart - base;
+    while (diverge < lines[0].size() && diverge < lines[1].size() && lines[0][diverge] == lines[1][diverge])
+        diverge++;
+
+    uint64_t lineNumber = base + diverge + 1;
+    printf("The runs first differ in frame %u, at line %llu\n\n", (unsigned int)low + 1, (unsigned long long)lineNumber);
+
+    // Show the lines around the difference side by side, marking the ones that differ
+    printf("  %10s  %-*s | %s\n", "line", width, argv[1], argv[2]);
+    size_t from = (diverge > (size_t)context) ? diverge - context : 0;
+    size_t to = min(max(lines[0].size(), lines[1].size()), diverge + context + 1);
+    for (size_t i = from; i < to; i++)
+    {
+        bool differs = column(lines[0], i) != column(lines[1], i) || (i < lines[0].size()) != (i < lines[1].size());
+        printf("%c %10llu  %-*s | %s\n", differs ? '>' : ' ', (unsigned long long)(base + i + 1),
+            width, column(lines[0], i).c_str(), column(lines[1], i).c_str());
+    }
+
+    return 1;
+}